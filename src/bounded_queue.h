@@ -0,0 +1,43 @@
+#pragma once
+
+#include <deque>
+#include <mutex>
+#include <condition_variable>
+
+// blocking queue between one producer and one consumer thread, either side can close it
+template <typename T>
+class bounded_queue
+{
+public:
+	bounded_queue(size_t capacity) : m_capacity(capacity) {}
+	bool push(T item) { // false if the queue was closed
+		std::unique_lock<std::mutex> lock(m_mutex);
+		m_not_full.wait(lock, [this] { return m_closed || m_items.size() < m_capacity; });
+		if (m_closed) return false;
+		m_items.push_back(std::move(item));
+		m_not_empty.notify_one();
+		return true;
+	}
+	bool pop(T &item) { // false once the queue is closed and empty
+		std::unique_lock<std::mutex> lock(m_mutex);
+		m_not_empty.wait(lock, [this] { return m_closed || !m_items.empty(); });
+		if (m_items.empty()) return false;
+		item = std::move(m_items.front());
+		m_items.pop_front();
+		m_not_full.notify_one();
+		return true;
+	}
+	void close() {
+		std::lock_guard<std::mutex> lock(m_mutex);
+		m_closed = true;
+		m_not_empty.notify_all();
+		m_not_full.notify_all();
+	}
+private:
+	size_t m_capacity;
+	bool m_closed = false;
+	std::deque<T> m_items;
+	std::mutex m_mutex;
+	std::condition_variable m_not_empty;
+	std::condition_variable m_not_full;
+};
@@ -0,0 +1,167 @@
+#include "cache.h"
+
+#include <fstream>
+#include <cstring>
+#include <ctime>
+#include <algorithm>
+
+uint64_t hash_bytes(const char *bytes, size_t size, uint64_t hash) {
+	// multiply and xorshift per 64 bit word, bytes of a partial word are mixed in one by one
+	const uint64_t prime = 0x9e3779b97f4a7c15ULL;
+	size_t i = 0;
+	for (; i + 8 <= size; i += 8) {
+		uint64_t word;
+		std::memcpy(&word, bytes + i, 8);
+		hash = (hash ^ word) * prime;
+		hash ^= hash >> 29;
+	}
+	for (; i < size; ++i) hash = (hash ^ (unsigned char)bytes[i]) * 0x100000001b3ULL;
+	hash ^= size;
+	return (hash ^ (hash >> 32)) * prime;
+}
+
+uint64_t hash_file(const fs::path &path, uint64_t hash, uint64_t &size) {
+	std::ifstream infile(path.string(), std::ios::binary);
+	if (!infile) throw "Could not read file to hash!";
+	std::vector<char> buffer(CACHE_READ_CHUNK_SIZE);
+	size = 0;
+	while (infile) {
+		infile.read(buffer.data(), buffer.size());
+		std::streamsize num_read = infile.gcount();
+		if (num_read <= 0) break;
+		hash = hash_bytes(buffer.data(), (size_t)num_read, hash);
+		size += (uint64_t)num_read;
+	}
+	return hash;
+}
+
+Cache::Cache(fs::path directory, uint64_t max_bytes) : m_directory(directory), m_max_bytes(max_bytes) {
+	if (!fs::exists(m_directory)) fs::create_directories(m_directory);
+	if (!fs::is_directory(m_directory)) throw "Cache path does not describe a directory!";
+	evict(); // the limit holds even for runs that only read from the cache
+}
+
+uint64_t Cache::input_hash(const fs::path &input) {
+	uint64_t size;
+	return hash_file(input, 0, size);
+}
+
+std::string Cache::key(uint64_t input_hash, std::string options) const {
+	options = std::string(CACHE_FORMAT) + ";" + options;
+	uint64_t hash = hash_bytes(options.data(), options.size(), input_hash);
+	std::stringstream ss;
+	ss << std::hex << std::setw(16) << std::setfill('0') << hash;
+	return ss.str();
+}
+
+fs::path Cache::temporary_path(std::string key) const {
+	return m_directory / fs::unique_path(key + "-%%%%-%%%%-%%%%" + CACHE_TEMPORARY_EXTENSION);
+}
+
+bool Cache::verify(std::string key) {
+	fs::path entry = m_directory / fs::path(key);
+	if (!fs::is_directory(entry) || !fs::exists(entry / CACHE_CHECK_FILE)) return false;
+	std::ifstream infile((entry / CACHE_CHECK_FILE).string());
+	uint64_t expected_size = 0, expected_hash = 0, size = 0, hash = 0;
+	infile >> expected_size >> std::hex >> expected_hash;
+	bool valid = (bool)infile;
+	infile.close();
+	try {
+		if (valid) hash = hash_file(entry / CACHE_ENTRY_FILE, 0, size);
+	}
+	catch (const char *) {
+		return false; // removed by another run meanwhile
+	}
+	if (!valid || size != expected_size || hash != expected_hash) {
+		std::cerr << "WARNING: Removing corrupt cache entry " << key << "!" << std::endl;
+		remove(key);
+		return false;
+	}
+	boost::system::error_code error;
+	fs::last_write_time(entry, std::time(nullptr), error); // least recently used entries are evicted first
+	return true;
+}
+
+bool Cache::contains(std::string key) {
+	return verify(key);
+}
+
+bool Cache::load(std::string key, Hypergraph &h) {
+	// a private copy cannot be evicted by another run while it is parsed
+	fs::path graph_path = temporary_path(key);
+	if (!copy(key, graph_path)) return false;
+	h = Hypergraph(graph_path.string(), false, false);
+	fs::remove(graph_path);
+	return true;
+}
+
+bool Cache::copy(std::string key, const fs::path &destination) {
+	if (!verify(key)) return false;
+	boost::system::error_code error;
+	fs::copy_file(m_directory / fs::path(key) / CACHE_ENTRY_FILE, destination, fs::copy_option::overwrite_if_exists, error);
+	return !error;
+}
+
+void Cache::store(std::string key, const Hypergraph &h) {
+	fs::path temporary = temporary_path(key);
+	fs::create_directory(temporary);
+	h.save((temporary / CACHE_ENTRY_FILE).string());
+	uint64_t size;
+	uint64_t hash = hash_file(temporary / CACHE_ENTRY_FILE, 0, size);
+	std::ofstream outfile;
+	outfile.open((temporary / CACHE_CHECK_FILE).string());
+	outfile << size << " " << std::hex << hash << std::endl;
+	outfile.close();
+	boost::system::error_code error;
+	fs::rename(temporary, m_directory / fs::path(key), error);
+	if (error && !fs::exists(m_directory / fs::path(key) / CACHE_CHECK_FILE)) {
+		// entries are complete once renamed into place, so one without a check file was damaged outside of enumhyp
+		remove(key);
+		fs::rename(temporary, m_directory / fs::path(key), error);
+	}
+	if (error) fs::remove_all(temporary); // another run stored the entry first
+	evict();
+}
+
+void Cache::remove(std::string key) {
+	fs::path removed = temporary_path(key);
+	boost::system::error_code error;
+	fs::rename(m_directory / fs::path(key), removed, error);
+	if (!error) fs::remove_all(removed, error);
+}
+
+void Cache::evict() {
+	std::vector<std::pair<std::time_t, std::string>> entries;
+	uint64_t total_size = 0;
+	std::time_t now = std::time(nullptr);
+	boost::system::error_code error;
+	for (fs::directory_iterator it(m_directory); it != fs::directory_iterator(); ++it) {
+		if (!fs::is_directory(it->path(), error)) continue;
+		std::time_t modified = fs::last_write_time(it->path(), error);
+		if (error) continue;
+		if (it->path().extension() == CACHE_TEMPORARY_EXTENSION) {
+			if (now - modified > CACHE_STALE_TEMPORARY_S) fs::remove_all(it->path(), error);
+			continue;
+		}
+		uintmax_t size = fs::file_size(it->path() / CACHE_ENTRY_FILE, error);
+		if (error) continue;
+		// hashing every entry is too slow here, truncated ones are caught by their size alone
+		std::ifstream infile((it->path() / CACHE_CHECK_FILE).string());
+		uint64_t expected_size;
+		if (infile >> expected_size && expected_size != size) {
+			infile.close();
+			std::cerr << "WARNING: Removing corrupt cache entry " << it->path().filename().string() << "!" << std::endl;
+			remove(it->path().filename().string());
+			continue;
+		}
+		total_size += size;
+		entries.push_back(std::make_pair(modified, it->path().filename().string()));
+	}
+	std::sort(entries.begin(), entries.end());
+	for (auto &entry : entries) {
+		if (total_size <= m_max_bytes) break;
+		uintmax_t size = fs::file_size(m_directory / fs::path(entry.second) / CACHE_ENTRY_FILE, error);
+		if (!error) total_size -= size;
+		remove(entry.second);
+	}
+}
@@ -0,0 +1,40 @@
+#pragma once
+
+#include "globals.h"
+#include "hypergraph.h"
+
+#include <cstdint>
+
+#define CACHE_SIZE_MB 1024 // default limit of the cache directory
+#define CACHE_READ_CHUNK_SIZE (1 << 20)
+#define CACHE_ENTRY_FILE "entry.graph"
+#define CACHE_CHECK_FILE "entry.check"
+#define CACHE_TEMPORARY_EXTENSION ".tmp"
+#define CACHE_STALE_TEMPORARY_S 86400 // temporary directories of crashed runs are removed after this time
+#define CACHE_FORMAT "enumhyp-cache-2" // part of every key, change it when the graph or entry format changes
+
+uint64_t hash_bytes(const char *bytes, size_t size, uint64_t hash);
+uint64_t hash_file(const fs::path &path, uint64_t hash, uint64_t &size);
+
+// graphs and transversals keyed by the contents of their input file and the options they depend on,
+// each entry is a directory <key> with the graph and a check file holding its size and hash.
+// Entries are written to a unique temporary directory that is renamed into place, and renamed away before they are removed,
+// so runs sharing the cache only ever see complete entries
+class Cache
+{
+public:
+	Cache(fs::path directory, uint64_t max_bytes);
+	static uint64_t input_hash(const fs::path &input);
+	std::string key(uint64_t input_hash, std::string options) const;
+	bool contains(std::string key);
+	bool load(std::string key, Hypergraph &h); // unsorted and with duplicates, exactly as stored
+	bool copy(std::string key, const fs::path &destination);
+	void store(std::string key, const Hypergraph &h);
+private:
+	fs::path m_directory;
+	uint64_t m_max_bytes;
+	fs::path temporary_path(std::string key) const;
+	bool verify(std::string key);
+	void remove(std::string key);
+	void evict();
+};
@@ -0,0 +1,102 @@
+#include "column_statistics.h"
+
+#include <thread>
+#include <cmath>
+#include <algorithm>
+#include <unordered_map>
+#include <functional>
+
+HyperLogLog::HyperLogLog() : m_registers(1 << HYPERLOGLOG_PRECISION, 0) {
+}
+
+void HyperLogLog::add(const std::string &value) {
+	uint64_t hash = (uint64_t)std::hash<std::string>()(value);
+	hash ^= hash >> 33; // std::hash may be the identity on some platforms, so mix before splitting the bits
+	hash *= 0xff51afd7ed558ccdULL;
+	hash ^= hash >> 33;
+	hash *= 0xc4ceb9fe1a85ec53ULL;
+	hash ^= hash >> 33;
+	size_t i_register = (size_t)(hash >> (64 - HYPERLOGLOG_PRECISION));
+	uint64_t remaining = hash << HYPERLOGLOG_PRECISION;
+	uint8_t rank = 1;
+	while (rank <= 64 - HYPERLOGLOG_PRECISION && !(remaining & ((uint64_t)1 << 63))) {
+		remaining <<= 1;
+		++rank;
+	}
+	m_registers[i_register] = std::max(m_registers[i_register], rank);
+}
+
+double HyperLogLog::estimate() const {
+	double m = (double)m_registers.size();
+	double sum = 0;
+	int num_zero_registers = 0;
+	for (uint8_t r : m_registers) {
+		sum += std::ldexp(1.0, -r);
+		if (r == 0) ++num_zero_registers;
+	}
+	double estimate = 0.7213 / (1 + 1.079 / m) * m * m / sum;
+	if (estimate <= 2.5 * m && num_zero_registers > 0) return m * std::log(m / num_zero_registers); // linear counting for small cardinalities
+	return estimate;
+}
+
+static bool is_null(const std::string &field) {
+	return field == "NULL" || field == "null" || field == "\\N";
+}
+
+// accumulates the statistics of one column record by record
+class column_profiler
+{
+public:
+	column_profiler(bool approximate) : m_approximate(approximate) {}
+	void add(const std::string &field) {
+		if (field.empty()) ++m_statistics.num_empty;
+		else if (is_null(field)) ++m_statistics.num_null;
+		if (!m_approximate) {
+			++m_counters[field];
+			return;
+		}
+		// HyperLogLog for the number of unique values, Misra-Gries summary for the frequent ones
+		m_hll.add(field);
+		auto counter = m_counters.find(field);
+		if (counter != m_counters.end()) ++counter->second;
+		else if (m_counters.size() < (size_t)(8 * NUM_FREQUENT_VALUES)) m_counters[field] = 1;
+		else {
+			for (auto i = m_counters.begin(); i != m_counters.end(); ) {
+				if (--i->second == 0) i = m_counters.erase(i);
+				else ++i;
+			}
+		}
+	}
+	column_statistics finish() {
+		m_statistics.num_uniques = m_approximate ? (int)std::llround(m_hll.estimate()) : (int)m_counters.size();
+		std::vector<std::pair<std::string, int>> &values = m_statistics.frequent_values;
+		for (auto &counter : m_counters) values.push_back(std::make_pair(counter.first, counter.second));
+		auto middle = values.begin() + std::min(values.size(), (size_t)NUM_FREQUENT_VALUES);
+		std::partial_sort(values.begin(), middle, values.end(), [](const std::pair<std::string, int> &a, const std::pair<std::string, int> &b) { return a.second > b.second || (a.second == b.second && a.first < b.first); });
+		values.erase(middle, values.end());
+		return m_statistics;
+	}
+private:
+	bool m_approximate;
+	column_statistics m_statistics;
+	HyperLogLog m_hll;
+	std::unordered_map<std::string, int> m_counters; // exact frequencies or Misra-Gries counters
+};
+
+static void profile_column_slice(const records &m_records, bool approximate, record::size_type i_slice, std::vector<column_statistics> &statistics) {
+	std::vector<record::size_type> columns;
+	for (record::size_type i_column = i_slice; i_column < statistics.size(); i_column += NUM_THREADS) columns.push_back(i_column);
+	if (columns.empty()) return;
+	std::vector<column_profiler> profilers(columns.size(), column_profiler(approximate));
+	for (const record &r : m_records) for (size_t i = 0; i < columns.size(); ++i) profilers[i].add(r[columns[i]]);
+	for (size_t i = 0; i < columns.size(); ++i) statistics[columns[i]] = profilers[i].finish();
+}
+
+std::vector<column_statistics> profile_columns(const records &m_records, bool approximate) {
+	if (m_records.empty()) return std::vector<column_statistics>();
+	std::vector<column_statistics> statistics(m_records[0].size());
+	std::thread threads[NUM_THREADS];
+	for (int i = 0; i < NUM_THREADS; ++i) threads[i] = std::thread(&profile_column_slice, std::ref(m_records), approximate, (record::size_type)i, std::ref(statistics));
+	for (int i = 0; i < NUM_THREADS; ++i) threads[i].join();
+	return statistics;
+}
@@ -0,0 +1,31 @@
+#pragma once
+
+#include "globals.h"
+
+#include <cstdint>
+
+typedef std::vector<std::string> record;
+typedef std::vector<record> records;
+
+#define HYPERLOGLOG_PRECISION 12
+#define NUM_FREQUENT_VALUES 5
+
+struct column_statistics {
+	int num_uniques = 0; // estimated in approximate mode
+	int num_empty = 0;
+	int num_null = 0;
+	std::vector<std::pair<std::string, int>> frequent_values; // most frequent values first, lower bounds in approximate mode
+};
+
+// computes the statistics of all columns, each thread walks the records once for its slice of columns, header included like in every other table operation
+std::vector<column_statistics> profile_columns(const records &m_records, bool approximate);
+
+class HyperLogLog
+{
+public:
+	HyperLogLog();
+	void add(const std::string &value);
+	double estimate() const;
+private:
+	std::vector<uint8_t> m_registers;
+};
@@ -0,0 +1,262 @@
+#include "difference_sets.h"
+
+#include <cstring>
+#include <algorithm>
+
+#if defined(__GNUC__) && (defined(__x86_64__) || defined(__i386__))
+#define DIFFERENCE_SETS_X86
+#include <immintrin.h>
+#endif
+
+typedef void(*difference_kernel)(const compact_rows &rows, size_t i_row, size_t j_begin, size_t j_end, uint64_t *out);
+
+static void difference_block_scalar(const compact_rows &rows, size_t i_row, size_t j_begin, size_t j_end, uint64_t *out) {
+	const uint32_t *row = rows.row(i_row);
+	for (size_t j_row = j_begin; j_row < j_end; ++j_row, out += rows.num_words) {
+		const uint32_t *other = rows.row(j_row);
+		std::memset(out, 0, rows.num_words * sizeof(uint64_t));
+		for (size_t i_column = 0; i_column < rows.num_columns; ++i_column) {
+			if (row[i_column] != other[i_column]) out[i_column / 64] |= (uint64_t)1 << (i_column % 64);
+		}
+	}
+}
+
+#ifdef DIFFERENCE_SETS_X86
+__attribute__((target("avx2")))
+static void difference_block_avx2(const compact_rows &rows, size_t i_row, size_t j_begin, size_t j_end, uint64_t *out) {
+	const uint32_t *row = rows.row(i_row);
+	for (size_t j_row = j_begin; j_row < j_end; ++j_row, out += rows.num_words) {
+		const uint32_t *other = rows.row(j_row);
+		for (size_t i_word = 0; i_word < rows.num_words; ++i_word) {
+			uint64_t word = 0;
+			size_t end = std::min(rows.stride, (i_word + 1) * 64);
+			for (size_t i_column = i_word * 64; i_column < end; i_column += 8) {
+				__m256i a = _mm256_loadu_si256((const __m256i *)(row + i_column));
+				__m256i b = _mm256_loadu_si256((const __m256i *)(other + i_column));
+				uint64_t equal = (uint64_t)_mm256_movemask_ps(_mm256_castsi256_ps(_mm256_cmpeq_epi32(a, b)));
+				word |= (~equal & 0xFF) << (i_column % 64);
+			}
+			out[i_word] = word;
+		}
+	}
+}
+
+__attribute__((target("avx512f")))
+static void difference_block_avx512(const compact_rows &rows, size_t i_row, size_t j_begin, size_t j_end, uint64_t *out) {
+	const uint32_t *row = rows.row(i_row);
+	for (size_t j_row = j_begin; j_row < j_end; ++j_row, out += rows.num_words) {
+		const uint32_t *other = rows.row(j_row);
+		for (size_t i_word = 0; i_word < rows.num_words; ++i_word) {
+			uint64_t word = 0;
+			size_t end = std::min(rows.stride, (i_word + 1) * 64);
+			for (size_t i_column = i_word * 64; i_column < end; i_column += 16) {
+				__m512i a = _mm512_loadu_si512((const void *)(row + i_column));
+				__m512i b = _mm512_loadu_si512((const void *)(other + i_column));
+				word |= (uint64_t)_mm512_cmpneq_epi32_mask(a, b) << (i_column % 64);
+			}
+			out[i_word] = word;
+		}
+	}
+}
+#endif
+
+static difference_kernel select_difference_kernel() {
+#ifdef DIFFERENCE_SETS_X86
+	__builtin_cpu_init();
+	if (__builtin_cpu_supports("avx512f")) return &difference_block_avx512;
+	if (__builtin_cpu_supports("avx2")) return &difference_block_avx2;
+#endif
+	return &difference_block_scalar;
+}
+
+static const difference_kernel kernel = select_difference_kernel();
+
+void difference_block(const compact_rows &rows, size_t i_row, size_t j_begin, size_t j_end, uint64_t *out) {
+	kernel(rows, i_row, j_begin, j_end, out);
+}
+
+edge edge_from_words(const uint64_t *words, size_t num_words, edge::size_type size) {
+	if (edge::bits_per_block == 64) {
+		edge e(words, words + num_words);
+		e.resize(size);
+		return e;
+	}
+	edge e(size);
+	for (size_t i_word = 0; i_word < num_words; ++i_word) {
+		for (uint64_t word = words[i_word]; word != 0; word &= word - 1) {
+			int i_bit = 0;
+			while (!((word >> i_bit) & 1)) ++i_bit;
+			e[i_word * 64 + i_bit] = 1;
+		}
+	}
+	return e;
+}
+
+void words_from_edge(const edge &e, std::vector<uint64_t> &words) {
+	words.assign((e.size() + 63) / 64, 0);
+	if (edge::bits_per_block == 64) {
+		boost::to_block_range(e, words.begin());
+		return;
+	}
+	for (auto i = e.find_first(); i != edge::npos; i = e.find_next(i)) words[i / 64] |= (uint64_t)1 << (i % 64);
+}
+
+row_encoder::row_encoder(size_t num_columns, compact_rows &rows) : m_rows(rows), m_dictionaries(num_columns) {
+	m_rows.num_columns = num_columns;
+	m_rows.stride = (num_columns + 15) / 16 * 16;
+	m_rows.num_words = (num_columns + 63) / 64;
+	m_encoded.assign(m_rows.stride, 0);
+}
+
+bool row_encoder::add(const std::vector<std::string> &r) {
+	size_t hash = m_rows.num_columns;
+	for (size_t i_column = 0; i_column < m_rows.num_columns; ++i_column) {
+		auto inserted = m_dictionaries[i_column].insert(std::make_pair(r[i_column], (uint32_t)m_dictionaries[i_column].size()));
+		m_encoded[i_column] = inserted.first->second;
+		hash ^= m_encoded[i_column] + 0x9e3779b97f4a7c15ULL + (hash << 6) + (hash >> 2);
+	}
+	std::vector<size_t> &candidates = m_row_hashes[hash];
+	for (size_t i_row : candidates) {
+		if (std::equal(m_encoded.begin(), m_encoded.end(), m_rows.row(i_row))) return false;
+	}
+	candidates.push_back(m_rows.num_rows++);
+	m_rows.values.insert(m_rows.values.end(), m_encoded.begin(), m_encoded.end());
+	return true;
+}
+
+word_set::word_set(size_t num_words) : m_num_words(num_words), m_slots(1024, SIZE_MAX) {
+}
+
+size_t word_set::hash(const uint64_t *words) const {
+	uint64_t hash = m_num_words;
+	for (size_t i_word = 0; i_word < m_num_words; ++i_word) {
+		hash ^= words[i_word] + 0x9e3779b97f4a7c15ULL + (hash << 6) + (hash >> 2);
+		hash *= 0xff51afd7ed558ccdULL;
+	}
+	return (size_t)(hash ^ (hash >> 33));
+}
+
+bool word_set::insert(const uint64_t *words) {
+	if ((size() + 1) * 2 > m_slots.size()) grow();
+	size_t mask = m_slots.size() - 1;
+	for (size_t i_slot = hash(words) & mask; ; i_slot = (i_slot + 1) & mask) {
+		if (m_slots[i_slot] == SIZE_MAX) {
+			m_slots[i_slot] = size();
+			m_words.insert(m_words.end(), words, words + m_num_words);
+			return true;
+		}
+		if (std::equal(words, words + m_num_words, &m_words[m_slots[i_slot] * m_num_words])) return false;
+	}
+}
+
+size_t word_set::size() const {
+	return m_num_words == 0 ? 0 : m_words.size() / m_num_words;
+}
+
+static int words_count(const uint64_t *words, size_t num_words) {
+	int count = 0;
+	for (size_t i_word = 0; i_word < num_words; ++i_word) for (uint64_t word = words[i_word]; word != 0; word &= word - 1) ++count;
+	return count;
+}
+
+// packed sets as bit columns, row v holds one bit per set, set if the set contains v
+class subset_index
+{
+public:
+	subset_index(const std::vector<uint64_t> &sets, size_t num_words) : m_num_words(num_words), m_num_sets(num_words == 0 ? 0 : sets.size() / num_words), m_vertices(num_words, 0) {
+		m_num_set_words = (m_num_sets + 63) / 64;
+		m_incidence.assign(num_words * 64 * m_num_set_words, 0);
+		m_covered.resize(m_num_set_words);
+		for (size_t i_set = 0; i_set < m_num_sets; ++i_set) {
+			for (size_t i_word = 0; i_word < num_words; ++i_word) {
+				m_vertices[i_word] |= sets[i_set * num_words + i_word];
+				for (uint64_t word = sets[i_set * num_words + i_word]; word != 0; word &= word - 1) {
+					size_t v = i_word * 64 + __builtin_ctzll(word);
+					m_incidence[v * m_num_set_words + i_set / 64] |= (uint64_t)1 << (i_set % 64);
+				}
+			}
+		}
+	}
+	// a set is a subset of the candidate iff it contains none of the candidate's missing vertices
+	bool contains_subset_of(const uint64_t *candidate) {
+		if (m_num_sets == 0) return false;
+		std::fill(m_covered.begin(), m_covered.end(), 0);
+		for (size_t i_word = 0; i_word < m_num_words; ++i_word) {
+			for (uint64_t word = m_vertices[i_word] & ~candidate[i_word]; word != 0; word &= word - 1) {
+				const uint64_t *row = &m_incidence[(i_word * 64 + __builtin_ctzll(word)) * m_num_set_words];
+				for (size_t i_set_word = 0; i_set_word < m_num_set_words; ++i_set_word) m_covered[i_set_word] |= row[i_set_word];
+			}
+		}
+		for (size_t i_set_word = 0; i_set_word + 1 < m_num_set_words; ++i_set_word) if (~m_covered[i_set_word] != 0) return true;
+		uint64_t last_sets = m_num_sets % 64 == 0 ? ~(uint64_t)0 : ((uint64_t)1 << (m_num_sets % 64)) - 1;
+		return (~m_covered[m_num_set_words - 1] & last_sets) != 0;
+	}
+private:
+	size_t m_num_words;
+	size_t m_num_sets;
+	size_t m_num_set_words;
+	std::vector<uint64_t> m_vertices; // union of all sets
+	std::vector<uint64_t> m_incidence;
+	std::vector<uint64_t> m_covered;
+};
+
+void word_set::minimize() {
+	std::vector<uint64_t> old_sets(m_words.begin(), m_words.begin() + m_num_minimal * m_num_words);
+	// most new sets contain an old minimal one, so they are filtered before they are minimized among themselves
+	subset_index old_index(old_sets, m_num_words);
+	std::vector<uint64_t> new_sets;
+	for (size_t i_set = m_num_minimal * m_num_words; i_set < m_words.size(); i_set += m_num_words) {
+		if (!old_index.contains_subset_of(&m_words[i_set])) new_sets.insert(new_sets.end(), &m_words[i_set], &m_words[i_set] + m_num_words);
+	}
+	new_sets = minimal_words(new_sets, m_num_words);
+	// sets are distinct, so a subset from the other list is always a proper one
+	subset_index new_index(new_sets, m_num_words);
+	std::vector<uint64_t> kept_old;
+	for (size_t i_set = 0; i_set < old_sets.size(); i_set += m_num_words) {
+		if (!new_index.contains_subset_of(&old_sets[i_set])) kept_old.insert(kept_old.end(), &old_sets[i_set], &old_sets[i_set] + m_num_words);
+	}
+	m_words.clear();
+	m_slots.assign(1024, SIZE_MAX);
+	size_t i_old = 0, i_new = 0;
+	while (i_old < kept_old.size() || i_new < new_sets.size()) {
+		bool take_old = i_new == new_sets.size() || (i_old < kept_old.size() && words_count(&kept_old[i_old], m_num_words) <= words_count(&new_sets[i_new], m_num_words));
+		if (take_old) {
+			insert(&kept_old[i_old]);
+			i_old += m_num_words;
+		}
+		else {
+			insert(&new_sets[i_new]);
+			i_new += m_num_words;
+		}
+	}
+	m_num_minimal = size();
+}
+
+void word_set::grow() {
+	m_slots.assign(m_slots.size() * 2, SIZE_MAX);
+	size_t mask = m_slots.size() - 1;
+	for (size_t i_set = 0; i_set < size(); ++i_set) {
+		size_t i_slot = hash(&m_words[i_set * m_num_words]) & mask;
+		while (m_slots[i_slot] != SIZE_MAX) i_slot = (i_slot + 1) & mask;
+		m_slots[i_slot] = i_set;
+	}
+}
+
+std::vector<uint64_t> minimal_words(const std::vector<uint64_t> &sets, size_t num_words) {
+	std::vector<uint64_t> minimal;
+	if (num_words == 0) return minimal;
+	std::vector<std::pair<int, size_t>> order;
+	for (size_t i_set = 0; i_set * num_words < sets.size(); ++i_set) order.push_back(std::make_pair(words_count(&sets[i_set * num_words], num_words), i_set));
+	std::sort(order.begin(), order.end());
+	for (auto &entry : order) {
+		const uint64_t *candidate = &sets[entry.second * num_words];
+		bool insert = true;
+		for (size_t i_minimal = 0; insert && i_minimal < minimal.size(); i_minimal += num_words) { // smaller sets come first, so only subsets need to be checked
+			bool subset = true;
+			for (size_t i_word = 0; subset && i_word < num_words; ++i_word) subset = (minimal[i_minimal + i_word] & ~candidate[i_word]) == 0;
+			insert = !subset;
+		}
+		if (insert) minimal.insert(minimal.end(), candidate, candidate + num_words);
+	}
+	return minimal;
+}
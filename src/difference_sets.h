@@ -0,0 +1,52 @@
+#pragma once
+
+#include "globals.h"
+
+#include <cstdint>
+#include <unordered_map>
+
+// integer-encoded table, one row after another, each row padded to a multiple of 16 columns
+struct compact_rows {
+	std::vector<uint32_t> values;
+	size_t num_rows = 0;
+	size_t num_columns = 0;
+	size_t stride = 0;
+	size_t num_words = 0;
+	const uint32_t *row(size_t i_row) const { return values.data() + i_row * stride; }
+};
+
+// dictionary-encodes records one after another into rows, duplicates are skipped
+class row_encoder
+{
+public:
+	row_encoder(size_t num_columns, compact_rows &rows);
+	bool add(const std::vector<std::string> &r); // false if the record duplicates an earlier one
+private:
+	compact_rows &m_rows;
+	std::vector<std::unordered_map<std::string, uint32_t>> m_dictionaries;
+	std::unordered_map<size_t, std::vector<size_t>> m_row_hashes;
+	std::vector<uint32_t> m_encoded;
+};
+
+// open addressing hash set of packed sets with num_words 64-bit words each, kept in insertion order
+class word_set
+{
+public:
+	std::vector<uint64_t> m_words;
+	size_t m_num_minimal = 0; // after minimize, the first sets are minimal and ordered by size
+	word_set(size_t num_words);
+	bool insert(const uint64_t *words);
+	size_t size() const;
+	void minimize(); // drops the supersets of other sets, only those inserted since the last call are compared with all
+private:
+	size_t m_num_words;
+	std::vector<size_t> m_slots;
+	size_t hash(const uint64_t *words) const;
+	void grow();
+};
+
+// writes the difference set of row i_row and each row in [j_begin, j_end) as num_words 64-bit words to out
+void difference_block(const compact_rows &rows, size_t i_row, size_t j_begin, size_t j_end, uint64_t *out);
+std::vector<uint64_t> minimal_words(const std::vector<uint64_t> &sets, size_t num_words);
+edge edge_from_words(const uint64_t *words, size_t num_words, edge::size_type size);
+void words_from_edge(const edge &e, std::vector<uint64_t> &words);
@@ -30,6 +30,11 @@ struct enumerate_configuration {
 	fs::path statistics_directory;
 	bool collect_hitting_set_statistics;
 	bool collect_oracle_statistics;
+	fs::path checkpoint_path; // empty if not checkpointing
+	uint64_t checkpoint_interval_ns = 0;
+	uint64_t time_budget_ns = 0; // 0 for no limit
+	bool resume = false;
+	fs::path output_path; // hitting sets are appended here while checkpointing
 };
 
 void print_edge(const edge &e);
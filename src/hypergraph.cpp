@@ -1,14 +1,38 @@
 #include "hypergraph.h"
+#include "difference_sets.h"
+#include "profiler.h"
 
 #include <fstream>
 #include <sstream>
 #include <map>
 #include <utility>
+#include <thread>
+#include <atomic>
+#include <algorithm>
+#include <iterator>
+#include <cctype>
+#include <cmath>
+#include <random>
 
 #define NOT_EXTENDABLE 0
 #define EXTENDABLE 1
 #define MINIMAL 2
 
+#define SPARSE_DENSITY_THRESHOLD 0.03125
+
+#define GRAPH_CHUNK_SIZE (1 << 20) // bytes of a graph file parsed by one thread at least
+
+#define CHECKPOINT_NONE 0
+#define CHECKPOINT_SAVE 1
+#define CHECKPOINT_STOP 2
+
+#define BRUTE_FORCE_TIME_BUDGET_NS (12ULL * 3600 * 1000000000)
+#define BRUTE_FORCE_CHUNK_SIZE 64 // sets of a level joined by one thread at a time
+#define BRUTE_FORCE_ROUND_SIZE 65536 // sets of a level joined between two checkpoint checks
+
+#define NOT_HITTING 1
+#define NOT_MINIMAL 2
+
 Hypergraph::Hypergraph() {
 }
 
@@ -17,34 +41,96 @@ Hypergraph::Hypergraph(const Hypergraph &other) {
 	m_num_vertices = other.m_num_vertices;
 }
 
-Hypergraph::Hypergraph(std::string path) {
+// parses the edges in the lines [begin, end) of a graph file like std::stoi would, packed into words, duplicates within the chunk skipped if deduplicate is set
+static void parse_edges(const std::string &content, size_t begin, size_t end, int num_vertices, bool deduplicate, std::vector<uint64_t> &words, bool &corrupt) {
+	size_t num_words = ((size_t)num_vertices + 63) / 64;
+	word_set distinct(num_words);
+	std::vector<uint64_t> e(num_words);
+	const char *c = content.data() + begin;
+	const char *c_end = content.data() + end;
+	corrupt = false;
+	while (c < c_end) {
+		std::fill(e.begin(), e.end(), 0);
+		const char *line_end = std::find(c, c_end, '\n');
+		while (c < line_end) {
+			while (c < line_end && std::isspace((unsigned char)*c)) ++c;
+			bool negative = c < line_end && *c == '-';
+			if (c < line_end && (*c == '-' || *c == '+')) ++c;
+			if (c == line_end || !std::isdigit((unsigned char)*c)) {
+				corrupt = true;
+				return;
+			}
+			uint64_t i_vertex = 0;
+			for (; c < line_end && std::isdigit((unsigned char)*c); ++c) {
+				i_vertex = i_vertex * 10 + (uint64_t)(*c - '0');
+				if (i_vertex >= (uint64_t)num_vertices) negative = true; // out of range either way
+			}
+			if (negative) {
+				corrupt = true;
+				return;
+			}
+			e[i_vertex / 64] |= (uint64_t)1 << (i_vertex % 64);
+			c = std::find(c, line_end, ',');
+			if (c < line_end) ++c; // a trailing comma ends the edge like in std::getline
+		}
+		c = line_end + 1;
+		if (!deduplicate) words.insert(words.end(), e.begin(), e.end());
+		else distinct.insert(e.data());
+	}
+	if (deduplicate) words.swap(distinct.m_words);
+}
+
+Hypergraph::Hypergraph(std::string path, bool deduplicate, bool sort) {
 	m_edges.clear();
-	std::ifstream infile(path);
+	ScopedPhase phase(PHASE_GRAPH_LOAD);
+	std::ifstream infile(path, std::ios::binary);
 	std::string s_num_vertices;
 	getline(infile, s_num_vertices);
 	int num_vertices = std::stoi(s_num_vertices);
 	if (num_vertices <= 0) throw "Tried to read graph with less than one vertex from file!";
 	m_num_vertices = num_vertices;
-	edge_set edges;
-	for (std::string line; getline(infile, line); ) {
-		std::stringstream ss(line);
-		std::string node;
-		edge e((edge::size_type) num_vertices);
-		while (std::getline(ss, node, ',')) {
-			int i_vertex = std::stoi(node);
-			if (i_vertex < 0 || i_vertex >= num_vertices) throw "Found corrupt edge while reading graph from file!";
-			e[(edge::size_type) i_vertex] = 1;
-		}
-		edges.insert(e);
+	// read the rest at once and parse it in chunks that start at a line
+	std::string content((std::istreambuf_iterator<char>(infile)), std::istreambuf_iterator<char>());
+	int num_chunks = (int)std::min((size_t)NUM_THREADS, content.size() / GRAPH_CHUNK_SIZE + 1);
+	std::vector<size_t> chunk_begins(1, 0);
+	for (int i = 1; i < num_chunks; ++i) {
+		size_t i_char = std::max(chunk_begins.back(), content.size() / num_chunks * i);
+		while (i_char < content.size() && i_char > 0 && content[i_char - 1] != '\n') ++i_char;
+		chunk_begins.push_back(i_char);
 	}
-	for (auto e : edges) m_edges.push_back(e);
+	chunk_begins.push_back(content.size());
+	std::thread threads[NUM_THREADS];
+	std::vector<std::vector<uint64_t>> edge_words(num_chunks);
+	bool corrupt[NUM_THREADS];
+	for (int i = 0; i < num_chunks; ++i) threads[i] = std::thread(&parse_edges, std::ref(content), chunk_begins[i], chunk_begins[i + 1], num_vertices, deduplicate, std::ref(edge_words[i]), std::ref(corrupt[i]));
+	for (int i = 0; i < num_chunks; ++i) threads[i].join();
+	for (int i = 0; i < num_chunks; ++i) if (corrupt[i]) throw "Found corrupt edge while reading graph from file!";
+	std::string().swap(content);
+	size_t num_words = ((size_t)num_vertices + 63) / 64;
+	word_set distinct(num_words);
+	std::vector<uint64_t> &words = distinct.m_words;
+	for (int i = 0; i < num_chunks; ++i) {
+		if (!deduplicate) words.insert(words.end(), edge_words[i].begin(), edge_words[i].end());
+		else for (size_t i_word = 0; i_word < edge_words[i].size(); i_word += num_words) distinct.insert(&edge_words[i][i_word]);
+		std::vector<uint64_t>().swap(edge_words[i]);
+	}
+	std::vector<size_t> order(num_words == 0 ? 0 : words.size() / num_words);
+	for (size_t i = 0; i < order.size(); ++i) order[i] = i;
+	// same order as edge_set, dynamic_bitset compares its blocks starting with the last one
+	if (sort) std::sort(order.begin(), order.end(), [&words, num_words](size_t a, size_t b) {
+		for (size_t i_word = num_words; i_word > 0; --i_word) {
+			if (words[a * num_words + i_word - 1] != words[b * num_words + i_word - 1]) return words[a * num_words + i_word - 1] < words[b * num_words + i_word - 1];
+		}
+		return false;
+	});
+	m_edges.reserve(order.size());
+	for (size_t i : order) m_edges.push_back(edge_from_words(&words[i * num_words], num_words, (edge::size_type)num_vertices));
 }
 
 Hypergraph::Hypergraph(const Table &t) {
 	if (t.empty()) return;
 	m_num_vertices = (int)t.m_records[0].size();
-	m_edges = t.edges();
-	minimize();
+	m_edges = t.edges(); // already minimal
 }
 
 Hypergraph::Hypergraph(int num_vertices, edge_vec edges) {
@@ -60,6 +146,7 @@ void Hypergraph::print_edges() const {
 }
 
 void Hypergraph::save(std::string path) const {
+	ScopedPhase phase(PHASE_OUTPUT);
 	std::ofstream outfile;
 	outfile.open(path);
 	outfile << m_num_vertices << std::endl;
@@ -82,16 +169,68 @@ void Hypergraph::save(std::string path) const {
 }
 
 bool Hypergraph::is_hitting_set(const edge &h) const {
-	for (auto e : m_edges) if (!e.intersects(h)) return false;
+	if (sparse_index_valid()) {
+		for (edge_vec::size_type i_edge = 0; i_edge < m_edges.size(); ++i_edge) {
+			bool hit = false;
+			for (size_t i = m_sparse_offsets[i_edge]; !hit && i < m_sparse_offsets[i_edge + 1]; ++i) hit = h[m_sparse_edges[i]];
+			if (!hit) return false;
+		}
+		return true;
+	}
+	for (const edge &e : m_edges) if (!e.intersects(h)) return false;
 	return true;
 }
 
+void Hypergraph::build_index() {
+	// CSR incidence index (vertex -> edges containing it) and sorted vertex lists of all edges
+	m_incidence_offsets.assign(m_num_vertices + 1, 0);
+	m_sparse_offsets.assign(1, 0);
+	m_sparse_edges.clear();
+	size_t num_incidences = 0;
+	for (const edge &e : m_edges) {
+		for (auto v = e.find_first(); v != edge::npos; v = e.find_next(v)) {
+			m_sparse_edges.push_back((uint32_t)v);
+			++m_incidence_offsets[v + 1];
+		}
+		m_sparse_offsets.push_back(m_sparse_edges.size());
+		num_incidences += e.count();
+	}
+	for (int v = 0; v < m_num_vertices; ++v) m_incidence_offsets[v + 1] += m_incidence_offsets[v];
+	m_incidence.resize(num_incidences);
+	std::vector<size_t> position(m_incidence_offsets.begin(), m_incidence_offsets.end() - 1);
+	for (edge_vec::size_type i_edge = 0; i_edge < m_edges.size(); ++i_edge) {
+		for (size_t i = m_sparse_offsets[i_edge]; i < m_sparse_offsets[i_edge + 1]; ++i) m_incidence[position[m_sparse_edges[i]]++] = (uint32_t)i_edge;
+	}
+	m_hit_counts.assign(m_edges.size(), 0);
+	m_hit_vertices.assign(m_edges.size(), 0);
+	double density = m_edges.empty() ? 1.0 : (double)num_incidences / ((double)m_edges.size() * m_num_vertices);
+	m_sparse = density < SPARSE_DENSITY_THRESHOLD;
+}
+
+bool Hypergraph::sparse_index_valid() const {
+	return m_sparse && m_sparse_offsets.size() == m_edges.size() + 1;
+}
+
+bool Hypergraph::has_edge_within(const edge &y) {
+	if (sparse_index_valid()) {
+		std::fill(m_hit_counts.begin(), m_hit_counts.end(), 0);
+		for (auto v = y.find_first(); v != edge::npos; v = y.find_next(v)) {
+			for (size_t i = m_incidence_offsets[v]; i < m_incidence_offsets[v + 1]; ++i) ++m_hit_counts[m_incidence[i]];
+		}
+		for (edge_vec::size_type i_edge = 0; i_edge < m_edges.size(); ++i_edge) {
+			if (m_hit_counts[i_edge] == m_sparse_offsets[i_edge + 1] - m_sparse_offsets[i_edge]) return true;
+		}
+		return false;
+	}
+	return !is_hitting_set(~y);
+}
+
 int Hypergraph::extendable(const edge &x, const edge &y) {
 	if (m_configuration.collect_oracle_statistics) m_oracle_timestamp = Clock::now();
 	// 2
 	if (x.none()) {
 		// 3
-		if (is_hitting_set(~y)) {
+		if (!has_edge_within(y)) {
 			if (m_configuration.collect_oracle_statistics) {
 				auto now = Clock::now();
 				m_oracle_stats.add_record({ edge_to_string(x), edge_to_string(y), "3", ns_string(m_oracle_timestamp, now), "", "", "", "", "", "", "", "" });
@@ -106,6 +245,7 @@ int Hypergraph::extendable(const edge &x, const edge &y) {
 		return NOT_EXTENDABLE;
 	}
 	// 5
+	ScopedPhase partition_phase(PHASE_ORACLE_PARTITION, false);
 	edge_vec t;
 	// 6
 	std::vector<edge_vec> s(x.count(), edge_vec());
@@ -113,7 +253,22 @@ int Hypergraph::extendable(const edge &x, const edge &y) {
 	std::vector<edge_vec>::size_type s_index = -1;
 	for (auto x_index = x.find_first(); x_index != edge::npos; x_index = x.find_next(x_index)) x_index_to_s_index[x_index] = ++s_index;
 	// 7
-	for (edge e : m_edges) {
+	if (sparse_index_valid()) {
+		std::fill(m_hit_counts.begin(), m_hit_counts.end(), 0);
+		for (auto v = x.find_first(); v != edge::npos; v = x.find_next(v)) {
+			for (size_t i = m_incidence_offsets[v]; i < m_incidence_offsets[v + 1]; ++i) {
+				++m_hit_counts[m_incidence[i]];
+				m_hit_vertices[m_incidence[i]] = (uint32_t)v;
+			}
+		}
+		for (edge_vec::size_type i_edge = 0; i_edge < m_edges.size(); ++i_edge) {
+			// 9
+			if (m_hit_counts[i_edge] == 0) t.push_back(m_edges[i_edge] - y);
+			// 8
+			else if (m_hit_counts[i_edge] == 1) s[x_index_to_s_index[m_hit_vertices[i_edge]]].push_back(m_edges[i_edge] - y);
+		}
+	}
+	else for (const edge &e : m_edges) {
 		edge intersection = e & x;
 		// 9
 		if (intersection.none()) {
@@ -123,6 +278,7 @@ int Hypergraph::extendable(const edge &x, const edge &y) {
 		// 8
 		if (intersection.count() == 1) s[x_index_to_s_index[intersection.find_first()]].push_back(e - y);
 	}
+	partition_phase.stop();
 	// 10
 	for (auto sx : s) if (sx.empty()) {
 		if (m_configuration.collect_oracle_statistics) {
@@ -140,6 +296,7 @@ int Hypergraph::extendable(const edge &x, const edge &y) {
 		return MINIMAL;
 	}
 	// 12
+	ScopedPhase brute_force_phase(PHASE_ORACLE_BRUTE_FORCE, false);
 	if (m_configuration.collect_oracle_statistics) {
 		m_iteration_count = 0;
 		m_oracle_bf_timestamp = Clock::now();
@@ -183,8 +340,12 @@ int Hypergraph::extendable(const edge &x, const edge &y) {
 	return NOT_EXTENDABLE;
 }
 
-Hypergraph Hypergraph::enumerate(enumerate_configuration configuration) {
+void Hypergraph::prepare_enumeration(enumerate_configuration configuration) {
 	m_configuration = configuration;
+	m_frontier_depth = edge::npos;
+	m_frontier.clear();
+	build_index();
+	start_checkpointing();
 	if (m_configuration.collect_hitting_set_statistics) {
 		m_hitting_set_stats.clear();
 		m_hitting_set_stats.add_record({ "minimal_hitting_set", "delay_ns" });
@@ -193,23 +354,43 @@ Hypergraph Hypergraph::enumerate(enumerate_configuration configuration) {
 		m_oracle_stats.clear();
 		m_oracle_stats.add_record({ "x", "y", "return_line", "total_time_ns", "bf_time_ns", "actual_iteration_count", "maximum_iteration_count", "s_size", "summed_sx_sizes", "total_number_of_vertices_in_s", "t_size", "total_number_of_vertices_in_t" });
 	}
+}
+
+Hypergraph Hypergraph::enumerate(enumerate_configuration configuration) {
+	prepare_enumeration(configuration);
+	ScopedPhase phase(PHASE_ENUMERATION);
 	Hypergraph h;
 	if (m_configuration.implementation == "standard") h = Hypergraph(m_num_vertices, enumerate());
 	else if (m_configuration.implementation == "legacy") h = Hypergraph(m_num_vertices, enumerate_legacy());
 	else if (m_configuration.implementation == "brute_force") h = Hypergraph(m_num_vertices, brute_force_mhs());
 	else std::cerr << "Implementation " << m_configuration.implementation << " not found!";
+	phase.stop();
 	save_statistics();
 	return h;
 }
 
 edge_vec Hypergraph::enumerate() {
 	edge_vec minimal_hitting_sets;
+	m_results = &minimal_hitting_sets;
 	if (m_configuration.collect_hitting_set_statistics) m_hitting_set_timestamp = Clock::now();
-	enumerate(edge(m_num_vertices), edge(m_num_vertices), 0, minimal_hitting_sets);
+	if (m_configuration.resume) {
+		while (!m_pending.empty() && !m_stopped) {
+			subproblem p = m_pending.back();
+			m_pending.pop_back();
+			if (extendable(p.x, p.y)) enumerate(p.x, p.y, p.r, minimal_hitting_sets);
+		}
+	}
+	else enumerate(edge(m_num_vertices), edge(m_num_vertices), 0, minimal_hitting_sets);
+	finish_checkpointing();
 	return minimal_hitting_sets;
 }
 
 void Hypergraph::enumerate(const edge &x, const edge &y, edge::size_type r, edge_vec &minimal_hitting_sets) {
+	if (r == m_frontier_depth) {
+		m_frontier.push_back({ x, y, r });
+		return;
+	}
+	if (m_checkpointing && recursion_checkpoint(x, y, r) == CHECKPOINT_STOP) return;
 	edge xv = x;
 	xv[r] = 1;
 	switch (extendable(xv, y)) {
@@ -224,8 +405,19 @@ void Hypergraph::enumerate(const edge &x, const edge &y, edge::size_type r, edge
 		break;
 	}
 	case EXTENDABLE:
+	{
+		if (m_checkpointing) {
+			edge yv = y;
+			yv[r] = 1;
+			m_pending.push_back({ x, yv, r + 1 });
+		}
 		enumerate(xv, y, r + 1, minimal_hitting_sets);
+		if (m_checkpointing) {
+			m_pending.pop_back();
+			if (m_stopped) return;
+		}
 		break;
+	}
 	case NOT_EXTENDABLE:
 		edge yv = y;
 		yv[r] = 1;
@@ -237,14 +429,205 @@ void Hypergraph::enumerate(const edge &x, const edge &y, edge::size_type r, edge
 	if (extendable(x, yv)) enumerate(x, yv, r + 1, minimal_hitting_sets);
 }
 
+static std::string vertex_list(const edge &e) {
+	std::string s;
+	for (auto i = e.find_first(); i != edge::npos; i = e.find_next(i)) s += std::to_string(i) + ",";
+	if (!s.empty()) s.pop_back();
+	return s;
+}
+
+static edge parse_vertex_list(const std::string &s, int num_vertices) {
+	edge e((edge::size_type)num_vertices);
+	std::stringstream ss(s);
+	std::string node;
+	while (std::getline(ss, node, ',')) {
+		int i_vertex = std::stoi(node);
+		if (i_vertex < 0 || i_vertex >= num_vertices) throw "Found corrupt vertex while reading subproblems from file!";
+		e[(edge::size_type)i_vertex] = 1;
+	}
+	return e;
+}
+
+void Hypergraph::export_subproblems(enumerate_configuration configuration, edge::size_type depth, std::string path) {
+	// runs the standard recursion down to the given depth, hitting sets found above it are exported as solved lines
+	prepare_enumeration(configuration);
+	m_frontier_depth = depth;
+	edge_vec minimal_hitting_sets = enumerate();
+	m_frontier_depth = edge::npos;
+	std::ofstream outfile;
+	outfile.open(path);
+	outfile << m_num_vertices << std::endl;
+	for (const edge &h : minimal_hitting_sets) outfile << "hitting_set;" << vertex_list(h) << std::endl;
+	for (const subproblem &p : m_frontier) outfile << "subproblem;" << p.r << ";" << vertex_list(p.x) << ";" << vertex_list(p.y) << std::endl;
+	outfile.close();
+	m_frontier.clear();
+	save_statistics();
+}
+
+Hypergraph Hypergraph::solve_subproblems(enumerate_configuration configuration, std::string path, int shard, int num_shards) {
+	// solves every line of the work file whose index is congruent to shard modulo num_shards
+	prepare_enumeration(configuration);
+	std::ifstream infile(path);
+	std::string line;
+	if (!getline(infile, line) || std::stoi(line) != m_num_vertices) throw "Subproblems were exported for a graph with a different number of vertices!";
+	edge_vec minimal_hitting_sets;
+	if (m_configuration.collect_hitting_set_statistics) m_hitting_set_timestamp = Clock::now();
+	for (int i_line = 0; getline(infile, line); ) {
+		if (line.empty()) continue; // blank lines of edited or concatenated work files do not count
+		if (i_line++ % num_shards != shard) continue;
+		std::vector<std::string> fields;
+		std::stringstream ss(line);
+		for (std::string field; std::getline(ss, field, ';'); ) fields.push_back(field);
+		if (line.back() == ';') fields.push_back("");
+		if (fields.size() == 2 && fields[0] == "hitting_set") minimal_hitting_sets.push_back(parse_vertex_list(fields[1], m_num_vertices));
+		else if (fields.size() == 4 && fields[0] == "subproblem") enumerate(parse_vertex_list(fields[2], m_num_vertices), parse_vertex_list(fields[3], m_num_vertices), (edge::size_type)std::stoul(fields[1]), minimal_hitting_sets);
+		else throw "Found corrupt line while reading subproblems from file!";
+	}
+	save_statistics();
+	return Hypergraph(m_num_vertices, minimal_hitting_sets);
+}
+
+void Hypergraph::start_checkpointing() {
+	m_pending.clear();
+	m_results = nullptr;
+	m_num_flushed = 0;
+	m_num_flushed_before = 0;
+	m_stopped = false;
+	m_start_timestamp = Clock::now();
+	m_checkpoint_timestamp = m_start_timestamp;
+	m_time_budget_ns = m_configuration.time_budget_ns;
+	if (m_time_budget_ns == 0 && m_configuration.implementation == "brute_force") m_time_budget_ns = BRUTE_FORCE_TIME_BUDGET_NS;
+	m_checkpointing = !m_configuration.checkpoint_path.empty() || m_time_budget_ns > 0;
+	m_resume_offset = 0;
+	if (!m_checkpointing) return;
+	m_results_offset = 0;
+	if (m_configuration.resume) {
+		std::ifstream infile(m_configuration.checkpoint_path.string(), std::ios::binary);
+		std::string implementation, line;
+		if (!getline(infile, implementation) || implementation != m_configuration.implementation) throw "Checkpoint does not exist or was written by a different implementation!";
+		if (!getline(infile, line) || std::stoi(line) != m_num_vertices) throw "Checkpoint was written for a graph with a different number of vertices!";
+		if (!(infile >> m_num_flushed_before >> m_results_offset)) throw "Found corrupt checkpoint!";
+		getline(infile, line);
+		m_resume_offset = (std::streamoff)infile.tellg();
+		// brute_force reads its binary level state from m_resume_offset itself
+		while (m_configuration.implementation != "brute_force" && getline(infile, line)) {
+			if (line.empty()) continue;
+			std::vector<std::string> fields;
+			std::stringstream ss(line);
+			for (std::string field; std::getline(ss, field, ';'); ) fields.push_back(field);
+			if (line.back() == ';') fields.push_back("");
+			if (fields.size() != 4 || fields[0] != "subproblem") throw "Found corrupt checkpoint!";
+			m_pending.push_back({ parse_vertex_list(fields[2], m_num_vertices), parse_vertex_list(fields[3], m_num_vertices), (edge::size_type)std::stoul(fields[1]) });
+		}
+	}
+	if (!m_configuration.output_path.empty()) {
+		if (m_configuration.resume) fs::resize_file(m_configuration.output_path, (uintmax_t)m_results_offset); // hitting sets written after the last checkpoint are found again
+		else {
+			std::ofstream outfile;
+			outfile.open(m_configuration.output_path.string());
+			outfile << m_num_vertices << std::endl;
+			m_results_offset = (std::streamoff)outfile.tellp();
+			outfile.close();
+		}
+	}
+	// the budget starts once the checkpoint is loaded
+	m_start_timestamp = Clock::now();
+	m_checkpoint_timestamp = m_start_timestamp;
+}
+
+int Hypergraph::checkpoint_due() {
+	auto now = Clock::now();
+	if (m_time_budget_ns > 0 && duration_ns(m_start_timestamp, now) >= m_time_budget_ns) {
+		m_stopped = true;
+		return CHECKPOINT_STOP;
+	}
+	if (!m_configuration.checkpoint_path.empty() && m_configuration.checkpoint_interval_ns > 0 && duration_ns(m_checkpoint_timestamp, now) >= m_configuration.checkpoint_interval_ns) return CHECKPOINT_SAVE;
+	return CHECKPOINT_NONE;
+}
+
+Clock::time_point Hypergraph::checkpoint_deadline() const {
+	// the time at which checkpoint_due stops returning CHECKPOINT_NONE
+	Clock::time_point deadline = Clock::time_point::max();
+	if (m_time_budget_ns > 0) deadline = m_start_timestamp + std::chrono::duration_cast<Clock::duration>(std::chrono::nanoseconds(m_time_budget_ns));
+	if (!m_configuration.checkpoint_path.empty() && m_configuration.checkpoint_interval_ns > 0) deadline = std::min(deadline, m_checkpoint_timestamp + std::chrono::duration_cast<Clock::duration>(std::chrono::nanoseconds(m_configuration.checkpoint_interval_ns)));
+	return deadline;
+}
+
+int Hypergraph::recursion_checkpoint(const edge &x, const edge &y, edge::size_type r) {
+	if (m_stopped) return CHECKPOINT_STOP;
+	int due = checkpoint_due();
+	if (due == CHECKPOINT_NONE || m_configuration.checkpoint_path.empty()) return due;
+	// the branches still to do are the pending second branches of all open calls and the current call itself
+	std::ofstream outfile;
+	fs::path temporary_path;
+	open_checkpoint(outfile, temporary_path);
+	for (const subproblem &p : m_pending) outfile << "subproblem;" << p.r << ";" << vertex_list(p.x) << ";" << vertex_list(p.y) << '\n';
+	outfile << "subproblem;" << r << ";" << vertex_list(x) << ";" << vertex_list(y) << '\n';
+	close_checkpoint(outfile, temporary_path);
+	return due;
+}
+
+void Hypergraph::flush_results() {
+	if (m_results == nullptr) return;
+	if (m_configuration.output_path.empty() || m_num_flushed == m_results->size()) {
+		m_num_flushed = m_results->size();
+		return;
+	}
+	std::ofstream outfile;
+	outfile.open(m_configuration.output_path.string(), std::ios::out | std::ios::app);
+	for (; m_num_flushed < m_results->size(); ++m_num_flushed) outfile << vertex_list((*m_results)[m_num_flushed]) << '\n';
+	m_results_offset = (std::streamoff)outfile.tellp();
+	outfile.close();
+}
+
+void Hypergraph::open_checkpoint(std::ofstream &outfile, fs::path &temporary_path) {
+	// the implementation writes its state after the header, close_checkpoint moves the file into place
+	flush_results();
+	temporary_path = m_configuration.checkpoint_path;
+	temporary_path += ".tmp";
+	outfile.open(temporary_path.string(), std::ios::binary);
+	outfile << m_configuration.implementation << '\n';
+	outfile << m_num_vertices << '\n';
+	outfile << m_num_flushed_before + m_num_flushed << " " << m_results_offset << '\n';
+}
+
+void Hypergraph::close_checkpoint(std::ofstream &outfile, const fs::path &temporary_path) {
+	outfile.close();
+	if (outfile.fail()) throw "Could not write checkpoint!";
+	fs::rename(temporary_path, m_configuration.checkpoint_path);
+	m_checkpoint_timestamp = Clock::now();
+}
+
+void Hypergraph::finish_checkpointing() {
+	if (!m_checkpointing) return;
+	flush_results();
+	if (m_stopped) {
+		std::cerr << "Stopped " << m_configuration.name << " after " << time_string(m_start_timestamp, Clock::now()) << " due to the time budget, " << m_num_flushed_before + m_num_flushed << " hitting sets found so far";
+		if (!m_configuration.checkpoint_path.empty()) std::cerr << ", continue using --resume";
+		std::cerr << "." << std::endl;
+	}
+	else if (!m_configuration.checkpoint_path.empty() && fs::exists(m_configuration.checkpoint_path)) fs::remove(m_configuration.checkpoint_path);
+	m_results = nullptr;
+}
+
 edge_vec Hypergraph::enumerate_legacy() {
 	edge_vec minimal_hitting_sets;
+	m_results = &minimal_hitting_sets;
 	if (m_configuration.collect_hitting_set_statistics) m_hitting_set_timestamp = Clock::now();
-	enumerate_legacy(edge(m_num_vertices), edge(m_num_vertices), 0, minimal_hitting_sets);
+	if (m_configuration.resume) {
+		while (!m_pending.empty() && !m_stopped) {
+			subproblem p = m_pending.back();
+			m_pending.pop_back();
+			if (extendable(p.x, p.y)) enumerate_legacy(p.x, p.y, p.r, minimal_hitting_sets);
+		}
+	}
+	else enumerate_legacy(edge(m_num_vertices), edge(m_num_vertices), 0, minimal_hitting_sets);
+	finish_checkpointing();
 	return minimal_hitting_sets;
 }
 
 void Hypergraph::enumerate_legacy(const edge &x, const edge &y, edge::size_type r, edge_vec &minimal_hitting_sets) {
+	if (m_checkpointing && recursion_checkpoint(x, y, r) == CHECKPOINT_STOP) return;
 	if (r == m_num_vertices) {
 		minimal_hitting_sets.push_back(x);
 		if (m_configuration.collect_hitting_set_statistics) {
@@ -258,11 +641,91 @@ void Hypergraph::enumerate_legacy(const edge &x, const edge &y, edge::size_type
 	edge yv = y;
 	xv[r] = 1;
 	yv[r] = 1;
+	if (m_checkpointing) m_pending.push_back({ x, yv, r + 1 });
 	if (extendable(xv, y)) enumerate_legacy(xv, y, r + 1, minimal_hitting_sets);
+	if (m_checkpointing) {
+		m_pending.pop_back();
+		if (m_stopped) return;
+	}
 	if (extendable(x, yv)) enumerate_legacy(x, yv, r + 1, minimal_hitting_sets);
 }
 
+static void add_probe(double value, double &sum, double &sum_of_squares) {
+	sum += value;
+	sum_of_squares += value * value;
+}
+
+static estimate estimate_from_sums(double sum, double sum_of_squares, int num_probes) {
+	estimate e;
+	e.mean = sum / num_probes;
+	if (num_probes > 1) e.half_width = 1.96 * std::sqrt(std::max(0.0, (sum_of_squares - sum * e.mean) / (num_probes - 1)) / num_probes);
+	return e;
+}
+
+// Knuth estimator: each probe follows one random root-to-leaf path through the recursion of enumerate (or enumerate_legacy), a node counts as often as the product of the branching factors above it
+enumeration_estimate Hypergraph::estimate_enumeration(enumerate_configuration configuration, int num_probes, unsigned int seed) {
+	configuration.collect_hitting_set_statistics = false;
+	configuration.collect_oracle_statistics = false;
+	configuration.checkpoint_path.clear();
+	configuration.time_budget_ns = 0;
+	configuration.resume = false;
+	if (configuration.implementation != "standard" && configuration.implementation != "legacy") throw "Estimates are only available for the standard and legacy implementations!";
+	prepare_enumeration(configuration);
+	bool legacy = m_configuration.implementation == "legacy";
+	std::mt19937 g(seed);
+	double sums[4] = {}, sums_of_squares[4] = {};
+	for (int i_probe = 0; i_probe < num_probes; ++i_probe) {
+		edge x(m_num_vertices), y(m_num_vertices);
+		edge::size_type r = 0;
+		double weight = 1, num_minimal_hitting_sets = 0, num_nodes = 0, num_oracle_calls = 0, time_ns = 0;
+		while (true) {
+			auto start = Clock::now();
+			num_nodes += weight;
+			std::vector<subproblem> children;
+			if (legacy && r == (edge::size_type)m_num_vertices) {
+				num_minimal_hitting_sets += weight;
+				time_ns += weight * duration_ns(start, Clock::now());
+				break;
+			}
+			edge xv = x;
+			edge yv = y;
+			xv[r] = 1;
+			yv[r] = 1;
+			int result = extendable(xv, y);
+			int num_calls = 1;
+			if (!legacy && result == MINIMAL) num_minimal_hitting_sets += weight;
+			if (result == EXTENDABLE || (legacy && result == MINIMAL)) children.push_back({ xv, y, r + 1 });
+			if (!legacy && result == NOT_EXTENDABLE) children.push_back({ x, yv, r + 1 }); // known to be extendable
+			else {
+				++num_calls;
+				if (extendable(x, yv)) children.push_back({ x, yv, r + 1 });
+			}
+			num_oracle_calls += weight * num_calls;
+			time_ns += weight * duration_ns(start, Clock::now());
+			if (children.empty()) break;
+			subproblem &child = children[std::uniform_int_distribution<size_t>(0, children.size() - 1)(g)];
+			weight *= children.size();
+			x = child.x;
+			y = child.y;
+			r = child.r;
+		}
+		add_probe(num_minimal_hitting_sets, sums[0], sums_of_squares[0]);
+		add_probe(num_nodes, sums[1], sums_of_squares[1]);
+		add_probe(num_oracle_calls, sums[2], sums_of_squares[2]);
+		add_probe(time_ns / 1e9, sums[3], sums_of_squares[3]);
+	}
+	enumeration_estimate e;
+	e.num_probes = num_probes;
+	if (num_probes < 1) return e;
+	e.num_minimal_hitting_sets = estimate_from_sums(sums[0], sums_of_squares[0], num_probes);
+	e.num_nodes = estimate_from_sums(sums[1], sums_of_squares[1], num_probes);
+	e.num_oracle_calls = estimate_from_sums(sums[2], sums_of_squares[2], num_probes);
+	e.time_s = estimate_from_sums(sums[3], sums_of_squares[3], num_probes);
+	return e;
+}
+
 void Hypergraph::minimize() {
+	ScopedPhase phase(PHASE_MINIMIZATION);
 	edge_set new_edges;
 	for (edge old_edge : m_edges) {
 		bool insert = true;
@@ -282,6 +745,7 @@ void Hypergraph::minimize() {
 		}
 	}
 	m_edges = edge_vec(new_edges.begin(), new_edges.end());
+	m_sparse = false;
 }
 
 void Hypergraph::permute(permutation p) {
@@ -290,77 +754,226 @@ void Hypergraph::permute(permutation p) {
 		std::cerr << "Cannot apply permutation of length " << p.size() << " to graph with " << m_num_vertices << " vertices!" << std::endl;
 		return;
 	}
+	if (m_sparse_offsets.size() != m_edges.size() + 1) build_index();
 	edge_vec new_edges;
-	for (edge e : m_edges) {
+	for (edge_vec::size_type i_edge = 0; i_edge < m_edges.size(); ++i_edge) {
 		edge new_edge(m_num_vertices);
-		for (auto i = e.find_first(); i != edge::npos; i = e.find_next(i)) new_edge[p[i]] = 1;
+		for (size_t i = m_sparse_offsets[i_edge]; i < m_sparse_offsets[i_edge + 1]; ++i) new_edge[p[m_sparse_edges[i]]] = 1;
 		new_edges.push_back(new_edge);
 	}
 	m_edges = new_edges;
+	build_index();
+}
+
+// set-trie of sorted vertex lists, answers whether a set contains one of the inserted sets
+class set_trie
+{
+public:
+	set_trie() : m_nodes(1) {}
+	void insert(const uint32_t *vertices, size_t size) {
+		uint32_t i_node = 0;
+		for (size_t i = 0; i < size; ++i) {
+			std::vector<std::pair<uint32_t, uint32_t>> &children = m_nodes[i_node].children;
+			auto child = std::lower_bound(children.begin(), children.end(), std::make_pair(vertices[i], (uint32_t)0));
+			if (child == children.end() || child->first != vertices[i]) {
+				child = children.insert(child, std::make_pair(vertices[i], (uint32_t)m_nodes.size()));
+				uint32_t i_child = child->second;
+				m_nodes.push_back(node());
+				i_node = i_child;
+			}
+			else i_node = child->second;
+		}
+		m_nodes[i_node].terminal = true;
+	}
+	bool contains_subset_of(const uint32_t *vertices, size_t size) const {
+		return contains_subset_of(0, vertices, size);
+	}
+private:
+	struct node {
+		std::vector<std::pair<uint32_t, uint32_t>> children; // sorted by vertex
+		bool terminal = false;
+	};
+	std::vector<node> m_nodes;
+	bool contains_subset_of(uint32_t i_node, const uint32_t *vertices, size_t size) const {
+		const node &n = m_nodes[i_node];
+		if (n.terminal) return true;
+		auto child = n.children.begin();
+		for (size_t i = 0; i < size && child != n.children.end(); ++i) {
+			child = std::lower_bound(child, n.children.end(), std::make_pair(vertices[i], (uint32_t)0));
+			if (child != n.children.end() && child->first == vertices[i] && contains_subset_of(child->second, vertices + i + 1, size - i - 1)) return true;
+		}
+		return false;
+	}
+};
+
+// sets of one level as sorted vertex lists in lexicographic order, sets that only differ in their last vertex are siblings in the prefix tree and form a group
+struct apriori_level {
+	size_t set_size = 1;
+	std::vector<uint32_t> vertices;
+	std::vector<size_t> group_ends; // for each set, the end of its group
+	size_t size() const { return vertices.size() / set_size; }
+	const uint32_t *set(size_t i_set) const { return &vertices[i_set * set_size]; }
+	void find_groups() {
+		group_ends.assign(size(), size());
+		for (size_t i_set = size(); i_set-- > 1; ) {
+			bool same_prefix = std::equal(set(i_set - 1), set(i_set - 1) + set_size - 1, set(i_set));
+			group_ends[i_set - 1] = same_prefix ? group_ends[i_set] : i_set;
+		}
+	}
+};
+
+struct apriori_chunk {
+	std::vector<uint32_t> incomplete;
+	std::vector<uint32_t> minimal;
+};
+
+// joins each set of the chunks with its later siblings, candidates hitting every edge are minimal unless they contain a minimal hitting set of an earlier level.
+// No chunk is taken after the deadline, so the finished chunks are always the first next_chunk ones
+static void join_siblings(const apriori_level &level, size_t first_set, size_t end_set, const std::vector<uint64_t> &incidence, size_t num_edge_words, uint64_t last_word, const set_trie &minimal, Clock::time_point deadline, std::atomic<size_t> &next_chunk, std::vector<apriori_chunk> &chunks) {
+	std::vector<uint64_t> prefix_hits(num_edge_words);
+	std::vector<uint32_t> candidate(level.set_size + 1);
+	while (Clock::now() < deadline) {
+		size_t i_chunk = next_chunk++;
+		if (i_chunk >= chunks.size()) break;
+		apriori_chunk &chunk = chunks[i_chunk];
+		size_t chunk_end = std::min(end_set, first_set + (i_chunk + 1) * BRUTE_FORCE_CHUNK_SIZE);
+		for (size_t i_set = first_set + i_chunk * BRUTE_FORCE_CHUNK_SIZE; i_set < chunk_end; ++i_set) {
+			const uint32_t *s = level.set(i_set);
+			std::fill(prefix_hits.begin(), prefix_hits.end(), 0);
+			for (size_t i = 0; i < level.set_size; ++i) {
+				const uint64_t *row = &incidence[s[i] * num_edge_words];
+				for (size_t i_word = 0; i_word < num_edge_words; ++i_word) prefix_hits[i_word] |= row[i_word];
+			}
+			std::copy(s, s + level.set_size, candidate.begin());
+			for (size_t j_set = i_set + 1; j_set < level.group_ends[i_set]; ++j_set) {
+				uint32_t v = level.set(j_set)[level.set_size - 1];
+				const uint64_t *row = &incidence[v * num_edge_words];
+				bool hitting = true;
+				for (size_t i_word = 0; hitting && i_word < num_edge_words; ++i_word) hitting = (prefix_hits[i_word] | row[i_word]) == (i_word + 1 == num_edge_words ? last_word : ~(uint64_t)0);
+				candidate[level.set_size] = v;
+				if (!hitting) chunk.incomplete.insert(chunk.incomplete.end(), candidate.begin(), candidate.end());
+				else if (!minimal.contains_subset_of(candidate.data(), candidate.size())) chunk.minimal.insert(chunk.minimal.end(), candidate.begin(), candidate.end());
+			}
+		}
+	}
+}
+
+static void append_vertices(const edge &e, std::vector<uint32_t> &vertices) {
+	for (auto v = e.find_first(); v != edge::npos; v = e.find_next(v)) vertices.push_back((uint32_t)v);
 }
 
 edge_vec Hypergraph::brute_force_mhs() {
-	// brute force all minimal hitting sets
-	// this works a bit similar to the apriori algorithm
-	int check_time_and_memory_counter = 0;
-	auto exit_timestamp = Clock::now();
+	// brute force all minimal hitting sets level by level like the apriori algorithm, a set of the next level joins two siblings of the prefix tree
 	if (m_configuration.collect_hitting_set_statistics) m_hitting_set_timestamp = Clock::now();
 	edge_vec minimal_hitting_sets;
-	edge_vec incomplete_hitting_sets;
-	for (edge::size_type i = 0; i < m_num_vertices; ++i) {
-		edge e(m_num_vertices);
-		e[i] = 1;
-		if (is_hitting_set(e)) {
-			minimal_hitting_sets.push_back(e);
-		}
-		else incomplete_hitting_sets.push_back(e);
-	}
-	if (incomplete_hitting_sets.empty()) return minimal_hitting_sets;
-	for (int set_size = 1; set_size < m_num_vertices; ++set_size) {
-		edge_vec::size_type current_level_cutoff = minimal_hitting_sets.size();
-		edge_vec new_incomplete_hitting_sets;
-		for (edge_vec::size_type i_first_set = 0; i_first_set < incomplete_hitting_sets.size(); ++i_first_set) {
-			for (edge_vec::size_type i_second_set = i_first_set + 1; i_second_set < incomplete_hitting_sets.size(); ++i_second_set) {
-				edge first_set_minus_last_vertex = incomplete_hitting_sets[i_first_set];
-				first_set_minus_last_vertex[last_vertex(first_set_minus_last_vertex)] = 0;
-				if (first_set_minus_last_vertex.is_subset_of(incomplete_hitting_sets[i_second_set])) {
-					edge candidate = incomplete_hitting_sets[i_first_set] | incomplete_hitting_sets[i_second_set];
-					bool add_candidate = true;
-					for (edge_vec::size_type i = 0; i < current_level_cutoff; ++i) {
-						if (minimal_hitting_sets[i].is_subset_of(candidate)) {
-							add_candidate = false;
-							break;
-						}
-					}
-					if (add_candidate) {
-						if (is_hitting_set(candidate)) {
-							minimal_hitting_sets.push_back(candidate);
-							if (minimal_hitting_sets.size() == 81) {
-								std::cout << "";
-							};
-							if (m_configuration.collect_hitting_set_statistics) {
-								auto now = Clock::now();
-								m_hitting_set_stats.add_record({ edge_to_string(candidate), ns_string(m_hitting_set_timestamp, now) });
-								m_hitting_set_timestamp = Clock::now();
-							}
-						}
-						else new_incomplete_hitting_sets.push_back(candidate);
+	apriori_level level, next_level;
+	size_t first_set = 0;
+	edge_vec::size_type current_level_cutoff = 0;
+	m_results = &minimal_hitting_sets;
+	if (m_configuration.resume) {
+		// the checkpoint holds the remaining sets of the current level and the next level so far as binary vertex arrays,
+		// the minimal hitting sets are read back from the output file they were flushed to
+		std::ifstream infile(m_configuration.checkpoint_path.string(), std::ios::binary);
+		infile.seekg(m_resume_offset);
+		std::string kind;
+		size_t level_size, next_level_size;
+		if (!(infile >> kind >> level.set_size >> current_level_cutoff >> level_size >> next_level_size) || kind != "level" || infile.get() != '\n') throw "Found corrupt checkpoint!";
+		level.vertices.resize(level_size * level.set_size);
+		next_level.vertices.resize(next_level_size * (level.set_size + 1));
+		infile.read((char *)level.vertices.data(), level.vertices.size() * sizeof(uint32_t));
+		infile.read((char *)next_level.vertices.data(), next_level.vertices.size() * sizeof(uint32_t));
+		if (!infile) throw "Found corrupt checkpoint!";
+		infile.close();
+		minimal_hitting_sets = Hypergraph(m_configuration.output_path.string(), false, false).m_edges;
+		if (minimal_hitting_sets.size() != m_num_flushed_before || current_level_cutoff > minimal_hitting_sets.size()) throw "Checkpoint does not match the output file!";
+		m_num_flushed = minimal_hitting_sets.size();
+		m_num_flushed_before = 0;
+		m_start_timestamp = Clock::now();
+		m_checkpoint_timestamp = m_start_timestamp;
+	}
+	else {
+		for (edge::size_type i = 0; i < m_num_vertices; ++i) {
+			edge e(m_num_vertices);
+			e[i] = 1;
+			if (is_hitting_set(e)) minimal_hitting_sets.push_back(e);
+			else level.vertices.push_back((uint32_t)i);
+		}
+		if (level.vertices.empty()) {
+			finish_checkpointing();
+			return minimal_hitting_sets;
+		}
+		current_level_cutoff = minimal_hitting_sets.size();
+	}
+	size_t num_edge_words;
+	std::vector<uint64_t> incidence = incidence_matrix(num_edge_words);
+	uint64_t last_word = m_edges.size() % 64 == 0 ? ~(uint64_t)0 : ((uint64_t)1 << (m_edges.size() % 64)) - 1;
+	set_trie minimal;
+	std::vector<uint32_t> vertices;
+	for (edge_vec::size_type i = 0; i < current_level_cutoff; ++i) {
+		vertices.clear();
+		append_vertices(minimal_hitting_sets[i], vertices);
+		minimal.insert(vertices.data(), vertices.size());
+	}
+	while (level.set_size < (size_t)m_num_vertices) {
+		next_level.set_size = level.set_size + 1;
+		level.find_groups();
+		while (first_set < level.size()) {
+			// threads work on one round of sets at a time, the merged results are checkpointed in between.
+			// A round stops early at the next checkpoint or the end of the budget, small rounds are not worth starting threads for
+			size_t end_set = std::min(level.size(), first_set + BRUTE_FORCE_ROUND_SIZE);
+			std::vector<apriori_chunk> chunks((end_set - first_set + BRUTE_FORCE_CHUNK_SIZE - 1) / BRUTE_FORCE_CHUNK_SIZE);
+			std::atomic<size_t> next_chunk(0);
+			Clock::time_point deadline = checkpoint_deadline();
+			if (chunks.size() < NUM_THREADS) join_siblings(level, first_set, end_set, incidence, num_edge_words, last_word, minimal, deadline, next_chunk, chunks);
+			else {
+				std::thread threads[NUM_THREADS];
+				for (int i = 0; i < NUM_THREADS; ++i) threads[i] = std::thread(&join_siblings, std::ref(level), first_set, end_set, std::ref(incidence), num_edge_words, last_word, std::ref(minimal), deadline, std::ref(next_chunk), std::ref(chunks));
+				for (int i = 0; i < NUM_THREADS; ++i) threads[i].join();
+			}
+			chunks.resize(std::min(chunks.size(), next_chunk.load()));
+			end_set = std::min(end_set, first_set + chunks.size() * BRUTE_FORCE_CHUNK_SIZE);
+			for (const apriori_chunk &chunk : chunks) {
+				next_level.vertices.insert(next_level.vertices.end(), chunk.incomplete.begin(), chunk.incomplete.end());
+				for (size_t i = 0; i < chunk.minimal.size(); i += next_level.set_size) {
+					edge e(m_num_vertices);
+					for (size_t j = i; j < i + next_level.set_size; ++j) e[chunk.minimal[j]] = 1;
+					minimal_hitting_sets.push_back(e);
+					if (m_configuration.collect_hitting_set_statistics) {
+						auto now = Clock::now();
+						m_hitting_set_stats.add_record({ edge_to_string(e), ns_string(m_hitting_set_timestamp, now) });
+						m_hitting_set_timestamp = Clock::now();
 					}
 				}
-				else break;
 			}
-			check_time_and_memory_counter++;
-			if (check_time_and_memory_counter > 1000) {
-				check_time_and_memory_counter = 0;
-				if (std::chrono::duration_cast<std::chrono::minutes>(Clock::now() - exit_timestamp).count() >= 60 * 12) {
-					std::cerr << "Aborting due to time constraints, took " << time_string(exit_timestamp, Clock::now()) << "." << std::endl;
-					return edge_vec();
-				}				
+			first_set = end_set;
+			int due = checkpoint_due();
+			if (due != CHECKPOINT_NONE && !m_configuration.checkpoint_path.empty()) {
+				// sets before first_set were joined with all their later siblings already and are not needed any more
+				std::ofstream outfile;
+				fs::path temporary_path;
+				open_checkpoint(outfile, temporary_path);
+				outfile << "level " << level.set_size << " " << current_level_cutoff << " " << level.size() - first_set << " " << next_level.vertices.size() / next_level.set_size << '\n';
+				outfile.write((const char *)(level.vertices.data() + first_set * level.set_size), (level.size() - first_set) * level.set_size * sizeof(uint32_t));
+				outfile.write((const char *)next_level.vertices.data(), next_level.vertices.size() * sizeof(uint32_t));
+				close_checkpoint(outfile, temporary_path);
+			}
+			if (due == CHECKPOINT_STOP) {
+				finish_checkpointing();
+				return minimal_hitting_sets;
 			}
 		}
-		if (new_incomplete_hitting_sets.empty()) return minimal_hitting_sets;
-		incomplete_hitting_sets.swap(new_incomplete_hitting_sets);
+		if (next_level.vertices.empty()) break;
+		for (edge_vec::size_type i = current_level_cutoff; i < minimal_hitting_sets.size(); ++i) {
+			vertices.clear();
+			append_vertices(minimal_hitting_sets[i], vertices);
+			minimal.insert(vertices.data(), vertices.size());
+		}
+		std::swap(level, next_level);
+		next_level.vertices.clear();
+		first_set = 0;
+		current_level_cutoff = minimal_hitting_sets.size();
 	}
+	finish_checkpointing();
 	return minimal_hitting_sets;
 }
 
@@ -400,4 +1013,92 @@ void Hypergraph::save_statistics() {
 		oracle_statistics_path /= (m_configuration.name + "_" + m_configuration.implementation + "_oracle_statistics.csv");
 		m_oracle_stats.save(oracle_statistics_path.string());
 	}
-}
\ No newline at end of file
+}
+std::vector<uint64_t> Hypergraph::incidence_matrix(size_t &num_edge_words) const {
+	// row v holds one bit per edge, set if the edge contains v
+	num_edge_words = (m_edges.size() + 63) / 64;
+	std::vector<uint64_t> incidence((size_t)m_num_vertices * num_edge_words, 0);
+	for (edge_vec::size_type i_edge = 0; i_edge < m_edges.size(); ++i_edge) {
+		const edge &e = m_edges[i_edge];
+		for (auto v = e.find_first(); v != edge::npos; v = e.find_next(v)) incidence[v * num_edge_words + i_edge / 64] |= (uint64_t)1 << (i_edge % 64);
+	}
+	return incidence;
+}
+
+void Hypergraph::verify_sets(const Hypergraph &transversal, const std::vector<uint64_t> &incidence, size_t num_edge_words, edge_vec::size_type i_slice, std::vector<char> &failures) const {
+	std::vector<uint64_t> hit_once(num_edge_words);
+	std::vector<uint64_t> hit_twice(num_edge_words);
+	uint64_t last_word = m_edges.size() % 64 == 0 ? ~(uint64_t)0 : ((uint64_t)1 << (m_edges.size() % 64)) - 1;
+	for (edge_vec::size_type i_set = i_slice; i_set < transversal.m_edges.size(); i_set += NUM_THREADS) {
+		const edge &h = transversal.m_edges[i_set];
+		std::fill(hit_once.begin(), hit_once.end(), 0);
+		std::fill(hit_twice.begin(), hit_twice.end(), 0);
+		for (auto v = h.find_first(); v != edge::npos; v = h.find_next(v)) {
+			const uint64_t *row = &incidence[v * num_edge_words];
+			for (size_t i_word = 0; i_word < num_edge_words; ++i_word) {
+				hit_twice[i_word] |= hit_once[i_word] & row[i_word];
+				hit_once[i_word] |= row[i_word];
+			}
+		}
+		bool hitting = true;
+		for (size_t i_word = 0; hitting && i_word < num_edge_words; ++i_word) hitting = hit_once[i_word] == (i_word + 1 == num_edge_words ? last_word : ~(uint64_t)0);
+		if (!hitting) {
+			failures[i_set] = NOT_HITTING;
+			continue;
+		}
+		// every vertex needs a critical edge that no other vertex of the set hits
+		for (auto v = h.find_first(); v != edge::npos; v = h.find_next(v)) {
+			const uint64_t *row = &incidence[v * num_edge_words];
+			bool critical = false;
+			for (size_t i_word = 0; !critical && i_word < num_edge_words; ++i_word) critical = (row[i_word] & ~hit_twice[i_word]) != 0;
+			if (!critical) {
+				failures[i_set] = NOT_MINIMAL;
+				break;
+			}
+		}
+	}
+}
+
+verification_result Hypergraph::verify_transversal(const Hypergraph &transversal, bool check_duality) {
+	verification_result result;
+	result.num_sets = transversal.m_edges.size();
+	if (transversal.m_num_vertices != m_num_vertices) throw "Transversal hypergraph has a different number of vertices than the input graph!";
+	size_t num_edge_words;
+	std::vector<uint64_t> incidence = incidence_matrix(num_edge_words);
+	std::vector<char> failures(transversal.m_edges.size(), 0);
+	std::thread threads[NUM_THREADS];
+	for (int i = 0; i < NUM_THREADS; ++i) threads[i] = std::thread(&Hypergraph::verify_sets, this, std::ref(transversal), std::ref(incidence), num_edge_words, (edge_vec::size_type)i, std::ref(failures));
+	for (int i = 0; i < NUM_THREADS; ++i) threads[i].join();
+	word_set distinct_sets((m_num_vertices + 63) / 64);
+	std::vector<uint64_t> words;
+	for (edge_vec::size_type i_set = 0; i_set < transversal.m_edges.size(); ++i_set) {
+		words_from_edge(transversal.m_edges[i_set], words);
+		if (!distinct_sets.insert(words.data())) {
+			++result.num_duplicate_sets;
+			std::cerr << "Set " << i_set << " (" << edge_to_string(transversal.m_edges[i_set]) << ") is a duplicate!" << std::endl;
+		}
+		if (failures[i_set] == NOT_HITTING) {
+			++result.num_non_hitting_sets;
+			std::cerr << "Set " << i_set << " (" << edge_to_string(transversal.m_edges[i_set]) << ") is not a hitting set!" << std::endl;
+		}
+		if (failures[i_set] == NOT_MINIMAL) {
+			++result.num_non_minimal_sets;
+			std::cerr << "Set " << i_set << " (" << edge_to_string(transversal.m_edges[i_set]) << ") is not minimal!" << std::endl;
+		}
+	}
+	if (check_duality) {
+		// the sets are the complete transversal hypergraph iff their own transversal hypergraph is the minimized input
+		Hypergraph minimized(*this);
+		minimized.minimize();
+		Hypergraph sets(m_num_vertices, transversal.m_edges);
+		enumerate_configuration configuration;
+		configuration.implementation = "standard";
+		configuration.collect_hitting_set_statistics = false;
+		configuration.collect_oracle_statistics = false;
+		Hypergraph dual = sets.enumerate(configuration);
+		edge_set dual_edges(dual.m_edges.begin(), dual.m_edges.end());
+		edge_set minimized_edges(minimized.m_edges.begin(), minimized.m_edges.end());
+		result.duality = dual_edges == minimized_edges ? "true" : "false";
+	}
+	return result;
+}
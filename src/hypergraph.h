@@ -1,6 +1,7 @@
 #pragma once
 
 #include <vector>
+#include <iosfwd>
 
 #include <boost/filesystem.hpp>
 
@@ -9,6 +10,34 @@
 
 namespace fs = boost::filesystem;
 
+struct verification_result {
+	edge_vec::size_type num_sets = 0;
+	edge_vec::size_type num_non_hitting_sets = 0;
+	edge_vec::size_type num_non_minimal_sets = 0;
+	edge_vec::size_type num_duplicate_sets = 0;
+	std::string duality = "skipped"; // skipped | true | false
+	bool valid() const { return num_non_hitting_sets == 0 && num_non_minimal_sets == 0 && num_duplicate_sets == 0 && duality != "false"; }
+};
+
+struct estimate {
+	double mean = 0;
+	double half_width = 0; // of the 95% confidence interval
+};
+
+struct enumeration_estimate {
+	int num_probes = 0;
+	estimate num_minimal_hitting_sets;
+	estimate num_nodes; // recursive calls
+	estimate num_oracle_calls;
+	estimate time_s; // sequential running time
+};
+
+struct subproblem {
+	edge x;
+	edge y;
+	edge::size_type r;
+};
+
 class Hypergraph
 {
 public:
@@ -16,7 +45,7 @@ public:
 	edge_vec m_edges;
 	Hypergraph();
 	Hypergraph(const Hypergraph &other);
-	Hypergraph(std::string path);
+	Hypergraph(std::string path, bool deduplicate = true, bool sort = true);
 	Hypergraph(const Table &t);
 	Hypergraph(int num_vertices, edge_vec edges);
 	~Hypergraph();
@@ -26,9 +55,14 @@ public:
 	Hypergraph enumerate(enumerate_configuration configuration);
 	edge_vec enumerate();
 	edge_vec enumerate_legacy();
+	void export_subproblems(enumerate_configuration configuration, edge::size_type depth, std::string path);
+	Hypergraph solve_subproblems(enumerate_configuration configuration, std::string path, int shard, int num_shards);
 	void minimize();
 	void permute(permutation p);
 	edge_vec brute_force_mhs();
+	verification_result verify_transversal(const Hypergraph &transversal, bool check_duality);
+	enumeration_estimate estimate_enumeration(enumerate_configuration configuration, int num_probes, unsigned int seed);
+	void build_index();
 private:
 	enumerate_configuration m_configuration;
 	Table m_hitting_set_stats;
@@ -37,6 +71,37 @@ private:
 	Clock::time_point m_oracle_timestamp;
 	Clock::time_point m_oracle_bf_timestamp;
 	int m_iteration_count;
+	edge::size_type m_frontier_depth = edge::npos; // recursion stops at this depth and collects the pending branches in m_frontier
+	std::vector<subproblem> m_frontier;
+	bool m_checkpointing = false; // checkpoint path or time budget given
+	bool m_stopped = false;
+	uint64_t m_time_budget_ns = 0;
+	Clock::time_point m_start_timestamp;
+	Clock::time_point m_checkpoint_timestamp;
+	std::vector<subproblem> m_pending; // second branches of the open recursive calls
+	std::streamoff m_resume_offset = 0; // start of the implementation's state in the checkpoint
+	edge_vec *m_results = nullptr;
+	edge_vec::size_type m_num_flushed = 0;
+	uint64_t m_num_flushed_before = 0; // hitting sets written before resuming
+	std::streamoff m_results_offset = 0; // end of the flushed hitting sets in the output file
+	std::vector<size_t> m_incidence_offsets; // edges containing vertex v are m_incidence[m_incidence_offsets[v]] to m_incidence[m_incidence_offsets[v + 1] - 1]
+	std::vector<uint32_t> m_incidence;
+	std::vector<size_t> m_sparse_offsets; // same layout for the sorted vertices of each edge
+	std::vector<uint32_t> m_sparse_edges;
+	bool m_sparse = false; // oracle uses the index instead of the dense edges, chosen by build_index from the density
+	std::vector<size_t> m_hit_counts;
+	std::vector<uint32_t> m_hit_vertices;
+	bool sparse_index_valid() const;
+	bool has_edge_within(const edge &y);
+	void prepare_enumeration(enumerate_configuration configuration);
+	void start_checkpointing();
+	int checkpoint_due();
+	Clock::time_point checkpoint_deadline() const;
+	int recursion_checkpoint(const edge &x, const edge &y, edge::size_type r);
+	void flush_results();
+	void open_checkpoint(std::ofstream &outfile, fs::path &temporary_path);
+	void close_checkpoint(std::ofstream &outfile, const fs::path &temporary_path);
+	void finish_checkpointing();
 	int extendable(const edge &x, const edge &y);
 	void enumerate(const edge &x, const edge &y, edge::size_type r, edge_vec &minimal_hitting_sets);
 	void enumerate_legacy(const edge &x, const edge &y, edge::size_type r, edge_vec &minimal_hitting_sets);
@@ -45,4 +110,6 @@ private:
 	int total_number_of_vertices_in_s(std::vector<edge_vec> s);
 	int total_number_of_vertices_in_t(edge_vec t);
 	void save_statistics();
+	std::vector<uint64_t> incidence_matrix(size_t &num_edge_words) const;
+	void verify_sets(const Hypergraph &transversal, const std::vector<uint64_t> &incidence, size_t num_edge_words, edge_vec::size_type i_slice, std::vector<char> &failures) const;
 };
@@ -2,8 +2,16 @@
 
 #include "hypergraph.h"
 #include "table.h"
+#include "profiler.h"
+#include "policy.h"
+#include "cache.h"
 
 #include <random>
+#include <map>
+#include <memory>
+#include <algorithm>
+#include <cmath>
+#include <boost/algorithm/string.hpp>
 
 int main(int argc, char *argv[]) {
 	try {
@@ -13,15 +21,36 @@ int main(int argc, char *argv[]) {
 		po::options_description option_description("Available options");
 		option_description.add_options()
 			("help,h", "show help message")
-			("action,a", po::value<std::string>(&action)->default_value("enumerate"), "generate | enumerate")
+			("action,a", po::value<std::string>(&action)->default_value("enumerate"), "generate | enumerate | verify | merge | estimate | profile | features | train | columns")
 			("input,i", po::value<std::string>()->default_value(fs::current_path().string()), "path to a file or directory")
 			("output,o", po::value<std::string>(), "path to output file/directory")
 			("randomized_permutations,r", po::value<int>(&randomized_permutations)->default_value(0), "number of random permutations to use (uses input permutation by default)")
-			("implementation,I", po::value<std::vector<std::string>>(), "implementation(s) to use, can be used multiple times, available: standard | legacy | brute_force")
+			("implementation,I", po::value<std::vector<std::string>>(), "implementation(s) to use, can be used multiple times, available: standard | legacy | brute_force, optionally followed by @input | @degree_descending | @degree_ascending to reorder the vertices first, or auto to let the policy choose")
 			("statistics_directory,s", po::value<std::string>(&statistics_directory)->default_value(fs::current_path().string()), "path to a directory to write statistics to")
 			("hitting_set_statistics,H", "collect hitting set statistics")
 			("oracle_statistics,O", "collect oracle statistics")
 			("delimiter,d", po::value<char>()->default_value(','), "table delimiter used during graph generation")
+			("approximate", "estimate the column statistics with HyperLogLog and Misra-Gries sketches instead of counting every value (columns)")
+			("transversal,t", po::value<std::string>(), "path to the claimed transversal hypergraph file/directory to verify")
+			("duality,D", "also check that the claimed transversal hypergraph is complete (verify)")
+			("checkpoint", po::value<std::string>(), "path to a checkpoint file to save the enumeration state to periodically and when the time budget runs out")
+			("checkpoint_interval", po::value<int>()->default_value(600), "seconds between two checkpoints")
+			("resume", "continue the enumeration from the checkpoint, hitting sets are appended to the output file")
+			("time_budget", po::value<int>(), "seconds after which the enumeration stops (brute_force stops after 12 hours by default)")
+			("shard_depth", po::value<int>(), "write the subproblems at this recursion depth to the output file instead of enumerating (enumerate, standard only)")
+			("subproblems", po::value<std::string>(), "path to a subproblem file to solve instead of the whole graph (enumerate, standard only)")
+			("shard", po::value<int>()->default_value(0), "solve only the subproblems with this index modulo num_shards")
+			("num_shards", po::value<int>()->default_value(1), "number of shards the subproblems are split into")
+			("graph_output", po::value<std::string>(), "path to a file/directory to also write the generated graph to (profile)")
+			("policy", po::value<std::string>(), "path to a policy file written by train to use for -I auto instead of the built-in one")
+			("timings", po::value<std::vector<std::string>>(), "enumerate output(s) to train the policy on, can be used multiple times (train)")
+			("probes", po::value<int>()->default_value(1000), "number of random root-to-leaf probes of the recursion (estimate)")
+			("seed", po::value<unsigned int>(), "seed of the random probes (estimate, random by default)")
+			("lazy", "start from sampled difference sets and add those of record pairs that violate a found hitting set until all are unique column combinations, instead of generating the complete graph (profile)")
+			("keep_edge_order", "deduplicate the edges of input graphs without sorting them (enumerate)")
+			("cache", po::value<std::string>(), "path to a directory to reuse generated graphs and transversals from, keyed by the input file contents and the options they depend on (generate, enumerate, profile)")
+			("cache_size", po::value<int>()->default_value(CACHE_SIZE_MB), "size limit of the cache directory in MB, least recently used entries are evicted first")
+			("profile,P", "write a JSON report with phase timings and hardware counters per graph to the statistics directory (generate, enumerate)")
 			;
 
 		po::positional_options_description positional_options_description;
@@ -42,6 +71,9 @@ int main(int argc, char *argv[]) {
 		}
 
 		fs::path input = fs::system_complete(fs::path(variables_map["input"].as<std::string>()));
+		if (variables_map.count("profile")) profiler.enable();
+		std::unique_ptr<Cache> cache;
+		if (variables_map.count("cache")) cache.reset(new Cache(fs::system_complete(fs::path(variables_map["cache"].as<std::string>())), (uint64_t)std::max(variables_map["cache_size"].as<int>(), 0) << 20));
 
 		if (action == "enumerate") {
 
@@ -49,6 +81,9 @@ int main(int argc, char *argv[]) {
 			if (variables_map.count("implementation")) implementations = variables_map["implementation"].as<std::vector<std::string>>();
 			else implementations.push_back("standard");
 
+			verify_implementations(implementations);
+			Policy policy = variables_map.count("policy") ? Policy(fs::system_complete(fs::path(variables_map["policy"].as<std::string>())).string()) : Policy();
+
 			enumerate_configuration configuration;
 			configuration.statistics_directory = fs::system_complete(fs::path(variables_map["statistics_directory"].as<std::string>()));
 			configuration.collect_hitting_set_statistics = (bool)variables_map.count("hitting_set_statistics");
@@ -59,7 +94,63 @@ int main(int argc, char *argv[]) {
 				exit(EXIT_FAILURE);
 			}
 
+			bool sharded = variables_map.count("shard_depth") || variables_map.count("subproblems");
+			if (sharded) {
+				if (implementations.size() != 1 || implementations[0] != "standard" || randomized_permutations > 0 || fs::is_directory(input)) {
+					std::cerr << "Subproblems can only be used with a single graph, the standard implementation and no randomized permutations!" << std::endl;
+					exit(EXIT_FAILURE);
+				}
+				if (variables_map.count("shard_depth") && (!variables_map.count("output") || variables_map["shard_depth"].as<int>() < 0)) {
+					std::cerr << "Exporting subproblems requires an output file and a shard_depth of at least 0!" << std::endl;
+					exit(EXIT_FAILURE);
+				}
+				if (variables_map["num_shards"].as<int>() < 1 || variables_map["shard"].as<int>() < 0 || variables_map["shard"].as<int>() >= variables_map["num_shards"].as<int>()) {
+					std::cerr << "shard has to be between 0 and num_shards - 1!" << std::endl;
+					exit(EXIT_FAILURE);
+				}
+			}
+
+			if (variables_map.count("checkpoint")) configuration.checkpoint_path = fs::system_complete(fs::path(variables_map["checkpoint"].as<std::string>()));
+			configuration.checkpoint_interval_ns = (uint64_t)variables_map["checkpoint_interval"].as<int>() * 1000000000;
+			if (variables_map.count("time_budget")) configuration.time_budget_ns = (uint64_t)variables_map["time_budget"].as<int>() * 1000000000;
+			configuration.resume = (bool)variables_map.count("resume");
+			bool checkpointing = !configuration.checkpoint_path.empty() || configuration.time_budget_ns > 0;
+			if (!configuration.checkpoint_path.empty() && (implementations.size() != 1 || randomized_permutations > 0 || fs::is_directory(input) || sharded)) {
+				std::cerr << "Checkpoints can only be used with a single graph, a single implementation, no randomized permutations and no subproblems!" << std::endl;
+				exit(EXIT_FAILURE);
+			}
+			if (!configuration.checkpoint_path.empty() && !variables_map.count("output")) {
+				std::cerr << "Checkpoints require an output file the hitting sets are written to, use -o path/to/graph_transversal.graph!" << std::endl;
+				exit(EXIT_FAILURE);
+			}
+			if (configuration.resume && configuration.checkpoint_path.empty()) {
+				std::cerr << "Resuming requires a checkpoint, use --checkpoint path/to/file!" << std::endl;
+				exit(EXIT_FAILURE);
+			}
+			if (configuration.resume && !fs::exists(configuration.checkpoint_path)) {
+				std::cerr << "Checkpoint " << configuration.checkpoint_path << " does not exist, the enumeration may already be complete!" << std::endl;
+				exit(EXIT_FAILURE);
+			}
+			if (checkpointing && sharded) {
+				std::cerr << "Subproblems cannot be combined with a time budget!" << std::endl;
+				exit(EXIT_FAILURE);
+			}
+			if (checkpointing) {
+				for (std::string implementation : implementations) {
+					if (implementation == "auto" || implementation.find('@') != std::string::npos) {
+						std::cerr << "auto and vertex orders cannot be combined with checkpoints or a time budget!" << std::endl;
+						exit(EXIT_FAILURE);
+					}
+				}
+			}
+
+			if (cache && (randomized_permutations > 0 || sharded || checkpointing || configuration.collect_hitting_set_statistics || configuration.collect_oracle_statistics)) {
+				std::cerr << "WARNING: The cache is not used with randomized permutations, subproblems, checkpoints, time budgets or statistics." << std::endl;
+				cache.reset();
+			}
+
 			if (configuration.collect_hitting_set_statistics && configuration.collect_oracle_statistics) std::cerr << "WARNING: Collecting hitting set and oracle statistics at the same time. This will lead to imprecise hitting set running time measurements!" << std::endl;
+			if (profiler.m_enabled && (configuration.collect_hitting_set_statistics || configuration.collect_oracle_statistics)) std::cerr << "WARNING: Profiling while collecting statistics. The profiled enumeration and oracle phases include the statistics overhead!" << std::endl;
 
 			std::cout << "graph";
 			if (randomized_permutations > 0) std::cout << ",permutation";
@@ -67,19 +158,30 @@ int main(int argc, char *argv[]) {
 			std::cout << std::endl;
 
 			for (fs::path graph_path : files_from_path(input, GRAPH_EXTENSION)) {
-				Hypergraph h = Hypergraph(graph_path.string());
+				profiler.reset();
+				Hypergraph h;
+				bool loaded = false; // not needed if all transversals are cached
+				uint64_t input_hash = cache ? Cache::input_hash(graph_path) : 0;
 				configuration.name = graph_path.stem().string();
+				if (!cache) {
+					h = Hypergraph(graph_path.string(), true, !variables_map.count("keep_edge_order"));
+					loaded = true;
+				}
 				if (randomized_permutations == 0) {
 					std::cout << remove_quotations(graph_path.stem().string());
 					for (std::string implementation : implementations) {
 						configuration.implementation = implementation;
+						profiler.set_scope(implementation);
 						Hypergraph t;
 						auto start = Clock::now();
-						t = h.enumerate(configuration);
-						auto end = Clock::now();
-						std::cout <<"," << ns_string(start, end);
+						if (variables_map.count("shard_depth")) {
+							h.export_subproblems(configuration, (edge::size_type)variables_map["shard_depth"].as<int>(), fs::system_complete(fs::path(variables_map["output"].as<std::string>())).string());
+							std::cout << "," << ns_string(start, Clock::now());
+							continue;
+						}
+						fs::path output_path;
 						if (variables_map.count("output")) {
-							fs::path output_path = fs::system_complete(fs::path(variables_map["output"].as<std::string>()));
+							output_path = fs::system_complete(fs::path(variables_map["output"].as<std::string>()));
 							if (fs::is_directory(input)) {
 								if (!fs::exists(output_path)) {
 									std::cerr << "Output directory " << output_path << " does not exist!" << std::endl;
@@ -98,8 +200,30 @@ int main(int argc, char *argv[]) {
 									output_path.replace_extension(GRAPH_EXTENSION);
 								}
 							}
-							t.save(output_path.string());
 						}
+						std::string key;
+						if (cache) {
+							key = cache->key(input_hash, "transversal;keep_edge_order=" + std::to_string(variables_map.count("keep_edge_order")) + ";" + implementation_options(implementation, variables_map));
+							if (output_path.empty() ? cache->contains(key) : cache->copy(key, output_path)) {
+								std::cout << ","; // not a running time, train skips it
+								std::cerr << "Reusing cached transversal of " << configuration.name << " for " << implementation << std::endl;
+								continue;
+							}
+							if (!loaded) {
+								profiler.set_scope(""); // the graph is loaded once for all implementations
+								h = Hypergraph(graph_path.string(), true, !variables_map.count("keep_edge_order"));
+								loaded = true;
+								profiler.set_scope(implementation);
+								start = Clock::now();
+							}
+						}
+						if (checkpointing) configuration.output_path = output_path; // written while enumerating
+						if (variables_map.count("subproblems")) t = h.solve_subproblems(configuration, fs::system_complete(fs::path(variables_map["subproblems"].as<std::string>())).string(), variables_map["shard"].as<int>(), variables_map["num_shards"].as<int>());
+						else t = enumerate_implementation(h, configuration, implementation, policy);
+						auto end = Clock::now();
+						std::cout <<"," << ns_string(start, end);
+						if (!output_path.empty() && !checkpointing) t.save(output_path.string());
+						if (cache) cache->store(key, t);
 					}
 					std::cout << std::endl;
 				}
@@ -114,14 +238,16 @@ int main(int argc, char *argv[]) {
 						std::cout << remove_quotations(graph_path.stem().string()) << "," << permutation_string(p);
 						for (std::string implementation : implementations) {
 							configuration.implementation = implementation;
+							profiler.set_scope(implementation);
 							auto start = Clock::now();
-							h.enumerate(configuration);
+							enumerate_implementation(h, configuration, implementation, policy);
 							auto end = Clock::now();
 							std::cout << "," << ns_string(start, end);
 						}
 						std::cout << std::endl;
 					}
 				}
+				if (profiler.m_enabled) profiler.save(profile_report_path(configuration.statistics_directory, configuration.name, action).string(), configuration.name);
 			}
 		}
 		else if (action == "generate") {
@@ -145,10 +271,261 @@ int main(int argc, char *argv[]) {
 						output_path.replace_extension(GRAPH_EXTENSION);
 					}
 				}
+				std::string key;
+				if (cache) {
+					key = cache->key(Cache::input_hash(table_path), graph_options(variables_map));
+					if (cache->copy(key, output_path)) {
+						std::cerr << "Reusing cached graph of " << table_path.stem() << std::endl;
+						continue;
+					}
+				}
 				std::cerr << "Generating " << table_path.stem() << "..." << std::endl;
+				profiler.reset();
 				Table t = Table(table_path.string(), variables_map["delimiter"].as<char>());
 				Hypergraph h = Hypergraph(t);
 				h.save(output_path.string());
+				if (cache) cache->store(key, h);
+				if (profiler.m_enabled) profiler.save(profile_report_path(fs::system_complete(fs::path(statistics_directory)), table_path.stem().string(), action).string(), table_path.stem().string());
+			}
+		}
+		else if (action == "verify") {
+			if (!variables_map.count("transversal")) {
+				std::cerr << "No transversal hypergraph given, use -t path/to/file/or/directory!" << std::endl;
+				exit(EXIT_FAILURE);
+			}
+			fs::path transversal_input = fs::system_complete(fs::path(variables_map["transversal"].as<std::string>()));
+			verify_path(transversal_input);
+			bool all_valid = true;
+			std::cout << "graph,sets,non_hitting_sets,non_minimal_sets,duplicate_sets,dual,verification_time_ns" << std::endl;
+			for (fs::path graph_path : files_from_path(input, GRAPH_EXTENSION)) {
+				fs::path transversal_path = transversal_input;
+				if (fs::is_directory(transversal_path)) {
+					transversal_path /= fs::path(graph_path.stem().string() + "_transversal");
+					transversal_path.replace_extension(GRAPH_EXTENSION);
+				}
+				if (!fs::exists(transversal_path)) {
+					std::cerr << "Transversal hypergraph " << transversal_path << " does not exist!" << std::endl;
+					all_valid = false;
+					continue;
+				}
+				Hypergraph h = Hypergraph(graph_path.string());
+				Hypergraph t = Hypergraph(transversal_path.string(), false, false);
+				auto start = Clock::now();
+				verification_result result = h.verify_transversal(t, (bool)variables_map.count("duality"));
+				auto end = Clock::now();
+				std::cout << remove_quotations(graph_path.stem().string()) << "," << result.num_sets << "," << result.num_non_hitting_sets << "," << result.num_non_minimal_sets << "," << result.num_duplicate_sets << "," << result.duality << "," << ns_string(start, end) << std::endl;
+				all_valid = all_valid && result.valid();
+			}
+			if (!all_valid) return EXIT_FAILURE;
+		}
+		else if (action == "merge") {
+			if (!variables_map.count("output")) {
+				std::cerr << "Merging requires an output file, use -o path/to/file!" << std::endl;
+				exit(EXIT_FAILURE);
+			}
+			Hypergraph merged(0, edge_vec());
+			edge_set distinct_sets;
+			for (fs::path graph_path : files_from_path(input, GRAPH_EXTENSION)) {
+				Hypergraph h = Hypergraph(graph_path.string(), false, false);
+				if (merged.m_num_vertices == 0) merged.m_num_vertices = h.m_num_vertices;
+				if (h.m_num_vertices != merged.m_num_vertices) {
+					std::cerr << graph_path << " has " << h.m_num_vertices << " vertices, expected " << merged.m_num_vertices << "!" << std::endl;
+					exit(EXIT_FAILURE);
+				}
+				for (const edge &e : h.m_edges) {
+					if (distinct_sets.insert(e).second) merged.m_edges.push_back(e);
+					else std::cerr << "Skipping duplicate set " << edge_to_string(e) << " in " << graph_path << "!" << std::endl;
+				}
+			}
+			merged.save(fs::system_complete(fs::path(variables_map["output"].as<std::string>())).string());
+		}
+		else if (action == "profile") {
+			std::vector<std::string> implementations;
+			if (variables_map.count("implementation")) implementations = variables_map["implementation"].as<std::vector<std::string>>();
+			else implementations.push_back("standard");
+			verify_implementations(implementations);
+			bool lazy = (bool)variables_map.count("lazy");
+			if (lazy && variables_map.count("graph_output")) {
+				std::cerr << "The complete graph is not generated in lazy mode!" << std::endl;
+				return EXIT_FAILURE;
+			}
+			Policy policy = variables_map.count("policy") ? Policy(fs::system_complete(fs::path(variables_map["policy"].as<std::string>())).string()) : Policy();
+			enumerate_configuration configuration;
+			configuration.statistics_directory = fs::system_complete(fs::path(variables_map["statistics_directory"].as<std::string>()));
+			configuration.collect_hitting_set_statistics = (bool)variables_map.count("hitting_set_statistics");
+			configuration.collect_oracle_statistics = (bool)variables_map.count("oracle_statistics");
+			if (cache && (configuration.collect_hitting_set_statistics || configuration.collect_oracle_statistics)) {
+				std::cerr << "WARNING: The cache is not used with statistics." << std::endl;
+				cache.reset();
+			}
+			std::cout << "table,generation_time_ns";
+			for (std::string implementation : implementations) std::cout << "," << implementation << "_running_time_ns";
+			std::cout << std::endl;
+			for (fs::path table_path : files_from_path(input, TABLE_EXTENSION)) {
+				profiler.reset();
+				configuration.name = table_path.stem().string();
+				auto start = Clock::now();
+				uint64_t input_hash = cache ? Cache::input_hash(table_path) : 0;
+				std::vector<std::string> keys;
+				bool generate = !cache || variables_map.count("graph_output"); // not needed if all transversals are cached
+				for (std::string implementation : implementations) {
+					if (!cache) break;
+					keys.push_back(cache->key(input_hash, "transversal;" + graph_options(variables_map) + ";generator=" + (lazy ? "lazy" : "complete") + ";" + implementation_options(implementation, variables_map)));
+					if (!cache->contains(keys.back())) generate = true;
+				}
+				Hypergraph h(0, edge_vec());
+				compact_rows rows;
+				bool has_duplicates = false;
+				bool unhittable = false; // duplicate records leave an empty difference set, which nothing hits, the engines must not get it
+				std::string graph_key = cache && !lazy ? cache->key(input_hash, graph_options(variables_map)) : "";
+				if (generate && (graph_key.empty() || !cache->load(graph_key, h))) {
+					record::size_type num_columns = 0;
+					edge_vec edges;
+					if (lazy) {
+						Table t(table_path.string(), variables_map["delimiter"].as<char>());
+						if (!t.empty()) {
+							num_columns = t.m_records[0].size();
+							rows = t.encode(has_duplicates);
+							edges = has_duplicates ? edge_vec(1, edge(num_columns)) : Table::sampled_edges(rows);
+						}
+					}
+					else edges = Table::edges_from_file(table_path.string(), variables_map["delimiter"].as<char>(), num_columns);
+					h = Hypergraph((int)num_columns, edges); // already minimal
+					unhittable = has_duplicates || std::any_of(h.m_edges.begin(), h.m_edges.end(), [](const edge &e) { return e.none(); });
+					if (!graph_key.empty() && !unhittable) cache->store(graph_key, h); // saving drops the empty edge
+				}
+				std::cout << remove_quotations(table_path.stem().string()) << "," << ns_string(start, Clock::now());
+				if (unhittable) std::cerr << "WARNING: " << table_path.stem() << " contains duplicate records and has no unique column combinations!" << std::endl;
+				if (variables_map.count("graph_output")) h.save(output_file_path(fs::system_complete(fs::path(variables_map["graph_output"].as<std::string>())), table_path.stem().string(), fs::is_directory(input)).string());
+				for (size_t i_implementation = 0; i_implementation < implementations.size(); ++i_implementation) {
+					std::string implementation = implementations[i_implementation];
+					configuration.implementation = implementation;
+					profiler.set_scope(implementation);
+					start = Clock::now();
+					fs::path output_path;
+					if (variables_map.count("output")) output_path = output_file_path(fs::system_complete(fs::path(variables_map["output"].as<std::string>())), table_path.stem().string() + "_transversal", fs::is_directory(input));
+					if (cache && (output_path.empty() ? cache->contains(keys[i_implementation]) : cache->copy(keys[i_implementation], output_path))) {
+						std::cout << ","; // not a running time, train skips it
+						std::cerr << "Reusing cached transversal of " << configuration.name << " for " << implementation << std::endl;
+						continue;
+					}
+					Hypergraph t = unhittable ? Hypergraph(h.m_num_vertices, edge_vec()) : lazy && !h.m_edges.empty() ? enumerate_lazily(rows, h, configuration, implementation, policy) : enumerate_implementation(h, configuration, implementation, policy);
+					std::cout << "," << ns_string(start, Clock::now());
+					if (!output_path.empty()) t.save(output_path.string());
+					if (cache) cache->store(keys[i_implementation], t);
+				}
+				std::cout << std::endl;
+				if (profiler.m_enabled) profiler.save(profile_report_path(configuration.statistics_directory, configuration.name, action).string(), configuration.name);
+			}
+		}
+		else if (action == "columns") {
+			std::cout << "table,column,num_uniques,num_empty,num_null,frequent_values" << std::endl;
+			for (fs::path table_path : files_from_path(input, TABLE_EXTENSION)) {
+				Table t = Table(table_path.string(), variables_map["delimiter"].as<char>());
+				t.set_approximate_statistics((bool)variables_map.count("approximate"));
+				const std::vector<column_statistics> &statistics = t.statistics();
+				for (size_t i_column = 0; i_column < statistics.size(); ++i_column) {
+					const column_statistics &c = statistics[i_column];
+					std::cout << remove_quotations(table_path.stem().string()) << "," << i_column << "," << c.num_uniques << "," << c.num_empty << "," << c.num_null << ",\"";
+					for (size_t i_value = 0; i_value < c.frequent_values.size(); ++i_value) {
+						std::string value = c.frequent_values[i_value].first;
+						boost::replace_all(value, "\"", "\"\"");
+						std::cout << (i_value > 0 ? ";" : "") << value << ":" << c.frequent_values[i_value].second;
+					}
+					std::cout << "\"" << std::endl;
+				}
+			}
+		}
+		else if (action == "features") {
+			std::cout << "graph";
+			for (int i = 0; i < NUM_FEATURES; ++i) std::cout << "," << feature_names[i];
+			std::cout << std::endl;
+			for (fs::path graph_path : files_from_path(input, GRAPH_EXTENSION)) {
+				Hypergraph h = Hypergraph(graph_path.string());
+				graph_features f = compute_features(h);
+				std::cout << remove_quotations(graph_path.stem().string());
+				for (int i = 0; i < NUM_FEATURES; ++i) std::cout << "," << f.values[i];
+				std::cout << std::endl;
+			}
+		}
+		else if (action == "train") {
+			if (!variables_map.count("timings") || !variables_map.count("output")) {
+				std::cerr << "Training requires enumerate output, use --timings path/to/output.csv, and an output file, use -o path/to/policy.csv!" << std::endl;
+				exit(EXIT_FAILURE);
+			}
+			// mean running time of every configuration per graph, over all permutations and timing files
+			std::map<std::string, std::map<std::string, std::pair<double, int>>> running_times;
+			for (std::string timings_path : variables_map["timings"].as<std::vector<std::string>>()) {
+				Table timings(fs::system_complete(fs::path(timings_path)).string(), ',');
+				if (timings.empty()) continue;
+				const record &header = timings.m_records[0];
+				for (records::size_type i_record = 1; i_record < timings.m_records.size(); ++i_record) {
+					for (record::size_type i_column = 1; i_column < header.size(); ++i_column) {
+						std::string column = header[i_column];
+						std::string suffix = "_running_time_ns";
+						if (column.size() <= suffix.size() || column.compare(column.size() - suffix.size(), suffix.size(), suffix) != 0) continue;
+						std::string configuration = column.substr(0, column.size() - suffix.size());
+						std::string implementation, order;
+						if (!parse_configuration(configuration, implementation, order)) continue;
+						if (i_column >= timings.m_records[i_record].size() || timings.m_records[i_record][i_column].empty()) continue; // reused from the cache
+						std::pair<double, int> &time = running_times[timings.m_records[i_record][0]][configuration];
+						time.first += std::stod(timings.m_records[i_record][i_column]);
+						++time.second;
+					}
+				}
+			}
+			Policy policy;
+			policy.clear(); // oracle costs differ between machines, so the built-in examples are not kept
+			for (fs::path graph_path : files_from_path(input, GRAPH_EXTENSION)) {
+				auto graph_times = running_times.find(remove_quotations(graph_path.stem().string()));
+				if (graph_times == running_times.end()) {
+					std::cerr << "No timings found for " << graph_path.stem() << ", skipping it." << std::endl;
+					continue;
+				}
+				std::string best;
+				double best_time = INFINITY;
+				for (auto &time : graph_times->second) {
+					if (time.second.first / time.second.second < best_time) {
+						best_time = time.second.first / time.second.second;
+						best = time.first;
+					}
+				}
+				Hypergraph h = Hypergraph(graph_path.string());
+				policy.add(compute_features(h), best);
+				std::cerr << graph_path.stem() << ": " << best << std::endl;
+			}
+			policy.save(fs::system_complete(fs::path(variables_map["output"].as<std::string>())).string());
+		}
+		else if (action == "estimate") {
+			std::vector<std::string> implementations;
+			if (variables_map.count("implementation")) implementations = variables_map["implementation"].as<std::vector<std::string>>();
+			else implementations.push_back("standard");
+			for (std::string implementation : implementations) {
+				if (implementation != "standard" && implementation != "legacy") {
+					std::cerr << "Estimates are only available for the standard and legacy implementations!" << std::endl;
+					exit(EXIT_FAILURE);
+				}
+			}
+			int num_probes = variables_map["probes"].as<int>();
+			if (num_probes < 1) {
+				std::cerr << "probes has to be at least 1!" << std::endl;
+				exit(EXIT_FAILURE);
+			}
+			unsigned int seed = variables_map.count("seed") ? variables_map["seed"].as<unsigned int>() : std::random_device()();
+			enumerate_configuration configuration;
+			std::cout << "graph,implementation,probes,minimal_hitting_sets,minimal_hitting_sets_ci95,recursive_calls,recursive_calls_ci95,oracle_calls,oracle_calls_ci95,predicted_time_s,predicted_time_s_ci95,estimation_time_ns" << std::endl;
+			for (fs::path graph_path : files_from_path(input, GRAPH_EXTENSION)) {
+				Hypergraph h = Hypergraph(graph_path.string());
+				configuration.name = graph_path.stem().string();
+				for (std::string implementation : implementations) {
+					configuration.implementation = implementation;
+					auto start = Clock::now();
+					enumeration_estimate e = h.estimate_enumeration(configuration, num_probes, seed);
+					auto end = Clock::now();
+					std::cout << remove_quotations(graph_path.stem().string()) << "," << implementation << "," << e.num_probes;
+					for (const estimate &value : { e.num_minimal_hitting_sets, e.num_nodes, e.num_oracle_calls, e.time_s }) std::cout << "," << value.mean << "," << value.half_width;
+					std::cout << "," << ns_string(start, end) << std::endl;
+				}
 			}
 		}
 		else {
@@ -164,10 +541,74 @@ int main(int argc, char *argv[]) {
 }
 
 void print_help(const po::options_description &option_description) {
-	std::cout << "Example usages:\n\tenumhyp enumerate path/to/graph.graph\n\tenumhyp enumerate path/to/graph/directory -r 50 -i standard -i legacy -s path/to/statistics/directory -O\n\tenumhyp generate path/to/table.csv\n\tenumhyp generate path/to/table.csv -d ; -o path/to/graph.graph\n\tenumhyp generate path/to/table/directory\n";
+	std::cout << "Example usages:\n\tenumhyp enumerate path/to/graph.graph\n\tenumhyp enumerate path/to/graph/directory -r 50 -i standard -i legacy -s path/to/statistics/directory -O\n\tenumhyp generate path/to/table.csv\n\tenumhyp generate path/to/table.csv -d ; -o path/to/graph.graph\n\tenumhyp generate path/to/table.csv -P -s path/to/statistics/directory\n\tenumhyp generate path/to/table/directory\n\tenumhyp verify path/to/graph.graph -t path/to/graph_transversal.graph -D\n\tenumhyp enumerate path/to/graph.graph --shard_depth 10 -o path/to/work.txt\n\tenumhyp enumerate path/to/graph.graph --subproblems path/to/work.txt --shard 0 --num_shards 4 -o path/to/shards/graph_0.graph\n\tenumhyp merge path/to/shards -o path/to/graph_transversal.graph\n\tenumhyp profile path/to/table.csv -I standard -o path/to/transversal/directory --graph_output path/to/graph/directory\n\tenumhyp profile path/to/table.csv --lazy -o path/to/transversal.graph\n\tenumhyp profile path/to/table/directory -o path/to/transversal/directory --cache path/to/cache --cache_size 4096\n\tenumhyp enumerate path/to/graph.graph -I auto\n\tenumhyp train path/to/graph/directory --timings path/to/enumerate_output.csv -o path/to/policy.csv\n\tenumhyp estimate path/to/graph.graph -I standard -I legacy --probes 10000\n\tenumhyp columns path/to/table.csv --approximate\n\tenumhyp enumerate path/to/graph.graph -o path/to/graph_transversal.graph --checkpoint path/to/checkpoint.txt --time_budget 3600 [--resume]\n";
 	std::cout << option_description;
 }
 
+void verify_implementations(const std::vector<std::string> &implementations) {
+	for (std::string implementation : implementations) {
+		std::string name, order;
+		if (implementation != "auto" && !parse_configuration(implementation, name, order)) {
+			std::cerr << "Implementation " << implementation << " not found!" << std::endl;
+			exit(EXIT_FAILURE);
+		}
+	}
+}
+
+Hypergraph enumerate_implementation(Hypergraph &h, enumerate_configuration configuration, std::string implementation, const Policy &policy) {
+	if (implementation == "auto") {
+		implementation = policy.choose(compute_features(h));
+		std::cerr << "Using " << implementation << " for " << configuration.name << std::endl;
+	}
+	std::string order;
+	parse_configuration(implementation, configuration.implementation, order);
+	if (order == "input") return h.enumerate(configuration);
+	// enumerate the reordered graph and map the hitting sets back
+	permutation p = vertex_order(h, order);
+	Hypergraph reordered = h;
+	reordered.permute(p);
+	Hypergraph t = reordered.enumerate(configuration);
+	t.permute(inverse(p));
+	return t;
+}
+
+Hypergraph enumerate_lazily(const compact_rows &rows, Hypergraph h, enumerate_configuration configuration, std::string implementation, const Policy &policy) {
+	// once every minimal hitting set of the partial graph is a unique column combination, it equals the transversal of the complete graph
+	edge_set unique_sets;
+	for (int round = 1; ; ++round) {
+		Hypergraph t = enumerate_implementation(h, configuration, implementation, policy);
+		edge_vec candidates, differences;
+		for (const edge &e : t.m_edges) if (unique_sets.count(e) == 0) candidates.push_back(e);
+		Table::find_violations(rows, candidates, differences);
+		size_t num_edges = h.m_edges.size();
+		for (size_t i = 0; i < candidates.size(); ++i) {
+			if (differences[i].empty()) unique_sets.insert(candidates[i]);
+			else h.m_edges.push_back(differences[i]);
+		}
+		if (h.m_edges.size() == num_edges) {
+			std::cerr << "Validated " << t.m_edges.size() << " unique column combinations of " << configuration.name << " after " << round << " round(s) with " << num_edges << " of its difference sets" << std::endl;
+			return t;
+		}
+		h.minimize();
+	}
+}
+
+fs::path profile_report_path(fs::path directory, std::string name, std::string action) {
+	return directory / fs::path(name + "_" + action + "_profile.json"); // generate and enumerate of the same table would overwrite each other's report otherwise
+}
+
+std::string graph_options(const po::variables_map &variables_map) {
+	return std::string("graph;delimiter=") + variables_map["delimiter"].as<char>();
+}
+
+std::string implementation_options(std::string implementation, const po::variables_map &variables_map) {
+	std::string options = "implementation=" + implementation;
+	if (implementation != "auto") return options;
+	// the chosen configuration and thus the order of the hitting sets depends on the policy
+	if (!variables_map.count("policy")) return options + ";policy=builtin";
+	return options + ";policy=" + std::to_string(Cache::input_hash(fs::system_complete(fs::path(variables_map["policy"].as<std::string>()))));
+}
+
 void verify_path(const fs::path &path) {
 	if (!fs::exists(path)) {
 		std::cerr << path << " does not exist!" << std::endl;
@@ -198,6 +639,24 @@ std::vector<fs::path> files_from_path(const fs::path &path, std::string extensio
 	return paths;
 }
 
+fs::path output_file_path(fs::path path, std::string name, bool input_is_directory) {
+	if (input_is_directory) {
+		if (!fs::exists(path)) {
+			std::cerr << "Output directory " << path << " does not exist!" << std::endl;
+			exit(EXIT_FAILURE);
+		}
+		if (!fs::is_directory(path)) {
+			std::cerr << "Directory given as input, but output path " << path << " does not describe a directory!" << std::endl;
+			exit(EXIT_FAILURE);
+		}
+	}
+	if (fs::is_directory(path)) {
+		path /= fs::path(name);
+		path.replace_extension(GRAPH_EXTENSION);
+	}
+	return path;
+}
+
 fs::path directory_from_path(fs::path path) {
 	verify_path(path);
 	if (fs::is_directory(path)) return path;
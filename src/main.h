@@ -1,6 +1,9 @@
 #pragma once
 
 #include "globals.h"
+#include "hypergraph.h"
+#include "policy.h"
+#include "difference_sets.h"
 
 #include <boost/program_options.hpp>
 #include <boost/filesystem.hpp>
@@ -9,6 +12,13 @@ namespace po = boost::program_options;
 namespace fs = boost::filesystem;
 
 void print_help(const po::options_description &option_description);
+void verify_implementations(const std::vector<std::string> &implementations);
+Hypergraph enumerate_implementation(Hypergraph &h, enumerate_configuration configuration, std::string implementation, const Policy &policy);
+Hypergraph enumerate_lazily(const compact_rows &rows, Hypergraph h, enumerate_configuration configuration, std::string implementation, const Policy &policy);
+fs::path profile_report_path(fs::path directory, std::string name, std::string action);
+std::string graph_options(const po::variables_map &variables_map);
+std::string implementation_options(std::string implementation, const po::variables_map &variables_map);
 void verify_path(const fs::path &path);
 std::vector<fs::path> files_from_path(const fs::path &path, std::string extension);
+fs::path output_file_path(fs::path path, std::string name, bool input_is_directory);
 fs::path directory_from_path(fs::path path);
\ No newline at end of file
@@ -0,0 +1,160 @@
+#include "policy.h"
+#include "table.h"
+
+#include <fstream>
+#include <cmath>
+#include <algorithm>
+
+const char *feature_names[NUM_FEATURES] = { "num_vertices", "num_edges", "min_edge_size", "mean_edge_size", "max_edge_size", "edge_size_stddev", "density", "degree_skew", "oracle_cost_ns" };
+
+// trained with enumhyp train on small UCC and random graphs with up to 100 vertices, see README
+static const char *builtin_policy[] = {
+	"18,30,3,4.16667,6,1.1571,0.231481,1.44,203583,brute_force",
+	"22,30,3,4.3,6,1.24231,0.195455,1.53488,222022,standard@degree_descending",
+	"10,38,3,4.18421,6,0.969407,0.418421,1.44654,219196,brute_force",
+	"12,121,4,6.52893,8,0.761408,0.544077,1.29114,1.44989e+06,brute_force",
+	"12,77,2,2.53247,3,0.498945,0.211039,1.35385,2.68727e+07,brute_force",
+	"18,40,3,4.025,5,0.790174,0.223611,1.45342,347704,brute_force",
+	"25,48,2,2.79167,4,0.762625,0.111667,5.78358,1.06674e+06,legacy@degree_descending",
+	"40,12,6,7.33333,9,1.10554,0.183333,1.81818,31138.9,standard@degree_descending",
+	"8,14,2,3.35714,5,0.971534,0.419643,1.3617,20946.3,standard",
+	"100,10,2,2.4,3,0.489898,0.024,8.33333,38851.4,standard@degree_descending",
+	nullptr
+};
+
+graph_features compute_features(Hypergraph &h) {
+	graph_features f;
+	double n = h.m_num_vertices, m = (double)h.m_edges.size();
+	f.values[0] = n;
+	f.values[1] = m;
+	if (h.m_edges.empty() || n == 0) return f;
+	std::vector<double> degrees((size_t)h.m_num_vertices, 0);
+	double min_size = n, max_size = 0, sum = 0, sum_of_squares = 0;
+	for (const edge &e : h.m_edges) {
+		double size = (double)e.count();
+		min_size = std::min(min_size, size);
+		max_size = std::max(max_size, size);
+		sum += size;
+		sum_of_squares += size * size;
+		for (auto v = e.find_first(); v != edge::npos; v = e.find_next(v)) ++degrees[v];
+	}
+	double mean_size = sum / m;
+	f.values[2] = min_size;
+	f.values[3] = mean_size;
+	f.values[4] = max_size;
+	f.values[5] = std::sqrt(std::max(0.0, sum_of_squares / m - mean_size * mean_size));
+	f.values[6] = mean_size / n;
+	f.values[7] = *std::max_element(degrees.begin(), degrees.end()) / (sum / n);
+	enumerate_configuration configuration;
+	configuration.implementation = "standard";
+	enumeration_estimate estimate = h.estimate_enumeration(configuration, FEATURE_PROBES, 0);
+	if (estimate.num_oracle_calls.mean > 0) f.values[8] = estimate.time_s.mean * 1e9 / estimate.num_oracle_calls.mean;
+	return f;
+}
+
+bool parse_configuration(std::string configuration, std::string &implementation, std::string &vertex_order) {
+	size_t separator = configuration.find('@');
+	implementation = configuration.substr(0, separator);
+	vertex_order = separator == std::string::npos ? "input" : configuration.substr(separator + 1);
+	if (implementation != "standard" && implementation != "legacy" && implementation != "brute_force") return false;
+	return vertex_order == "input" || vertex_order == "degree_descending" || vertex_order == "degree_ascending";
+}
+
+permutation vertex_order(const Hypergraph &h, std::string order) {
+	std::vector<size_t> degrees((size_t)h.m_num_vertices, 0);
+	for (const edge &e : h.m_edges) for (auto v = e.find_first(); v != edge::npos; v = e.find_next(v)) ++degrees[v];
+	std::vector<edge::size_type> vertices;
+	for (int v = 0; v < h.m_num_vertices; ++v) vertices.push_back((edge::size_type)v);
+	if (order == "degree_descending") std::stable_sort(vertices.begin(), vertices.end(), [&degrees](edge::size_type a, edge::size_type b) { return degrees[a] > degrees[b]; });
+	else if (order == "degree_ascending") std::stable_sort(vertices.begin(), vertices.end(), [&degrees](edge::size_type a, edge::size_type b) { return degrees[a] < degrees[b]; });
+	permutation p(vertices.size());
+	for (size_t i = 0; i < vertices.size(); ++i) p[vertices[i]] = i;
+	return p;
+}
+
+permutation inverse(const permutation &p) {
+	permutation q(p.size());
+	for (size_t i = 0; i < p.size(); ++i) q[p[i]] = i;
+	return q;
+}
+
+Policy::Policy() {
+	for (const char **line = builtin_policy; *line != nullptr; ++line) {
+		record r;
+		std::stringstream ss(*line);
+		for (std::string field; std::getline(ss, field, ','); ) r.push_back(field);
+		add_record(r);
+	}
+}
+
+Policy::Policy(std::string path) {
+	Table t(path, ',');
+	if (t.m_records.empty() || t.m_records[0].size() != NUM_FEATURES + 1) throw "Policy file does not have the expected columns!";
+	for (records::size_type i_record = 1; i_record < t.m_records.size(); ++i_record) add_record(t.m_records[i_record]);
+}
+
+void Policy::add_record(const std::vector<std::string> &r) {
+	if (r.size() != NUM_FEATURES + 1) throw "Found corrupt line in policy!";
+	graph_features f;
+	for (int i = 0; i < NUM_FEATURES; ++i) f.values[i] = std::stod(r[i]);
+	add(f, r[NUM_FEATURES]);
+}
+
+void Policy::clear() {
+	m_examples.clear();
+}
+
+void Policy::add(const graph_features &features, std::string configuration) {
+	std::string implementation, order;
+	if (!parse_configuration(configuration, implementation, order)) throw "Policy contains an unknown configuration!";
+	m_examples.push_back(std::make_pair(features, configuration));
+}
+
+std::string Policy::choose(const graph_features &features) const {
+	if (m_examples.empty()) return "standard";
+	// the fastest configuration of small graphs, brute_force in particular, may run out of memory on larger ones
+	for (int i = 0; i < NUM_SIZE_FEATURES; ++i) {
+		bool below = true, above = true;
+		for (auto &example : m_examples) {
+			if (features.values[i] >= example.first.values[i]) below = false;
+			if (features.values[i] <= example.first.values[i]) above = false;
+		}
+		if (below || above) return "standard";
+	}
+	// features are compared on a log scale, each scaled by its range among the examples
+	double low[NUM_FEATURES], high[NUM_FEATURES];
+	for (int i = 0; i < NUM_FEATURES; ++i) {
+		low[i] = high[i] = std::log1p(m_examples[0].first.values[i]);
+		for (auto &example : m_examples) {
+			low[i] = std::min(low[i], std::log1p(example.first.values[i]));
+			high[i] = std::max(high[i], std::log1p(example.first.values[i]));
+		}
+	}
+	double best_distance = INFINITY;
+	std::string best = m_examples[0].second;
+	for (auto &example : m_examples) {
+		double distance = 0;
+		for (int i = 0; i < NUM_FEATURES; ++i) {
+			double range = high[i] > low[i] ? high[i] - low[i] : 1;
+			double difference = (std::log1p(example.first.values[i]) - std::log1p(features.values[i])) / range;
+			distance += difference * difference;
+		}
+		if (distance < best_distance) {
+			best_distance = distance;
+			best = example.second;
+		}
+	}
+	return best;
+}
+
+void Policy::save(std::string path) const {
+	std::ofstream outfile;
+	outfile.open(path);
+	for (int i = 0; i < NUM_FEATURES; ++i) outfile << feature_names[i] << ",";
+	outfile << "configuration" << std::endl;
+	for (auto &example : m_examples) {
+		for (int i = 0; i < NUM_FEATURES; ++i) outfile << example.first.values[i] << ",";
+		outfile << example.second << std::endl;
+	}
+	outfile.close();
+}
@@ -0,0 +1,38 @@
+#pragma once
+
+#include "globals.h"
+#include "hypergraph.h"
+
+#define FEATURE_PROBES 16 // random probes used to sample the oracle cost
+#define NUM_FEATURES 9
+#define NUM_SIZE_FEATURES 2 // num_vertices and num_edges, the policy is only used for graphs within their range among the examples
+
+struct graph_features {
+	double values[NUM_FEATURES] = {}; // in the order of feature_names
+};
+
+extern const char *feature_names[NUM_FEATURES];
+
+// vertex and edge counts, edge size distribution, density, degree skew and the mean cost of the oracle calls of a few random probes
+graph_features compute_features(Hypergraph &h);
+
+// implementation[@vertex_order], e.g. standard@degree_descending
+bool parse_configuration(std::string configuration, std::string &implementation, std::string &vertex_order);
+// maps every vertex to its position in the given order: input | degree_descending | degree_ascending
+permutation vertex_order(const Hypergraph &h, std::string order);
+permutation inverse(const permutation &p);
+
+// nearest neighbour in log feature space among graphs whose fastest configuration is known, standard for graphs larger or smaller than all of them
+class Policy
+{
+public:
+	Policy(); // built-in
+	Policy(std::string path);
+	void clear();
+	void add(const graph_features &features, std::string configuration);
+	std::string choose(const graph_features &features) const;
+	void save(std::string path) const;
+private:
+	std::vector<std::pair<graph_features, std::string>> m_examples;
+	void add_record(const std::vector<std::string> &r);
+};
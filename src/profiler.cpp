@@ -0,0 +1,121 @@
+#include "profiler.h"
+
+#include <fstream>
+
+#ifdef __linux__
+#include <cstring>
+#include <unistd.h>
+#include <sys/syscall.h>
+#include <linux/perf_event.h>
+#endif
+
+Profiler profiler;
+
+static const char *phase_names[NUM_PHASES] = { "csv_load", "column_preprocessing", "difference_set_generation", "minimization", "graph_load", "enumeration", "oracle_partition", "oracle_brute_force", "output" };
+static const char *counter_names[NUM_COUNTERS] = { "cycles", "instructions", "cache_misses", "branch_misses" };
+
+Profiler::Profiler() {
+	for (int i = 0; i < NUM_COUNTERS; ++i) m_counter_fds[i] = -1;
+	reset();
+}
+
+Profiler::~Profiler() {
+#ifdef __linux__
+	for (int i = 0; i < NUM_COUNTERS; ++i) if (m_counter_fds[i] >= 0) close(m_counter_fds[i]);
+#endif
+}
+
+void Profiler::enable() {
+	m_enabled = true;
+#ifdef __linux__
+	// inherited counters also count the worker threads once they are joined
+	const uint64_t configs[NUM_COUNTERS] = { PERF_COUNT_HW_CPU_CYCLES, PERF_COUNT_HW_INSTRUCTIONS, PERF_COUNT_HW_CACHE_MISSES, PERF_COUNT_HW_BRANCH_MISSES };
+	for (int i = 0; i < NUM_COUNTERS; ++i) {
+		struct perf_event_attr attr;
+		std::memset(&attr, 0, sizeof(attr));
+		attr.size = sizeof(attr);
+		attr.type = PERF_TYPE_HARDWARE;
+		attr.config = configs[i];
+		attr.inherit = 1;
+		attr.exclude_kernel = 1;
+		attr.exclude_hv = 1;
+		m_counter_fds[i] = (int)syscall(__NR_perf_event_open, &attr, 0, -1, -1, 0);
+	}
+	if (!counters_available()) std::cerr << "WARNING: Hardware performance counters are not available, profiling timings only." << std::endl;
+#endif
+}
+
+void Profiler::reset() {
+	m_scopes.clear();
+	set_scope("");
+}
+
+void Profiler::set_scope(std::string scope) {
+	m_scope = scope;
+	for (auto &s : m_scopes) if (s.first == scope) return;
+	m_scopes.push_back(std::make_pair(scope, std::vector<phase_statistics>(NUM_PHASES)));
+}
+
+bool Profiler::counters_available() const {
+	for (int i = 0; i < NUM_COUNTERS; ++i) if (m_counter_fds[i] < 0) return false;
+	return true;
+}
+
+void Profiler::read_counters(uint64_t *values) const {
+	for (int i = 0; i < NUM_COUNTERS; ++i) {
+		values[i] = 0;
+#ifdef __linux__
+		if (m_counter_fds[i] >= 0 && read(m_counter_fds[i], &values[i], sizeof(uint64_t)) != sizeof(uint64_t)) values[i] = 0;
+#endif
+	}
+}
+
+void Profiler::record(int phase, uint64_t time_ns, const uint64_t *counters) {
+	for (auto &s : m_scopes) {
+		if (s.first != m_scope) continue;
+		phase_statistics &p = s.second[phase];
+		++p.calls;
+		p.time_ns += time_ns;
+		if (counters != nullptr) for (int i = 0; i < NUM_COUNTERS; ++i) p.counters[i] += counters[i];
+		return;
+	}
+}
+
+void Profiler::save(std::string path, std::string name) const {
+	std::ofstream outfile;
+	outfile.open(path);
+	outfile << "{\n\t\"graph\": \"" << remove_quotations(name) << "\",\n\t\"hardware_counters\": " << (counters_available() ? "true" : "false") << ",\n\t\"phases\": [";
+	bool first = true;
+	for (auto &s : m_scopes) {
+		for (int phase = 0; phase < NUM_PHASES; ++phase) {
+			const phase_statistics &p = s.second[phase];
+			if (p.calls == 0) continue;
+			outfile << (first ? "\n" : ",\n") << "\t\t{ \"phase\": \"" << phase_names[phase] << "\"";
+			if (!s.first.empty()) outfile << ", \"implementation\": \"" << s.first << "\"";
+			outfile << ", \"calls\": " << p.calls << ", \"time_ns\": " << p.time_ns;
+			// oracle phases are timed only
+			if (counters_available() && phase != PHASE_ORACLE_PARTITION && phase != PHASE_ORACLE_BRUTE_FORCE) for (int i = 0; i < NUM_COUNTERS; ++i) outfile << ", \"" << counter_names[i] << "\": " << p.counters[i];
+			outfile << " }";
+			first = false;
+		}
+	}
+	outfile << "\n\t]\n}" << std::endl;
+	outfile.close();
+}
+
+void ScopedPhase::start() {
+	if (m_read_counters) profiler.read_counters(m_counters);
+	m_start = Clock::now();
+}
+
+void ScopedPhase::finish() {
+	auto now = Clock::now();
+	if (!m_read_counters) {
+		profiler.record(m_phase, duration_ns(m_start, now), nullptr);
+		return;
+	}
+	uint64_t counters[NUM_COUNTERS];
+	profiler.read_counters(counters);
+	for (int i = 0; i < NUM_COUNTERS; ++i) counters[i] -= m_counters[i];
+	profiler.record(m_phase, duration_ns(m_start, now), counters);
+}
@@ -0,0 +1,69 @@
+#pragma once
+
+#include "globals.h"
+
+#include <cstdint>
+
+#define PHASE_CSV_LOAD 0
+#define PHASE_COLUMN_PREPROCESSING 1
+#define PHASE_DIFFERENCE_SET_GENERATION 2
+#define PHASE_MINIMIZATION 3
+#define PHASE_GRAPH_LOAD 4
+#define PHASE_ENUMERATION 5
+#define PHASE_ORACLE_PARTITION 6
+#define PHASE_ORACLE_BRUTE_FORCE 7
+#define PHASE_OUTPUT 8
+#define NUM_PHASES 9
+
+#define NUM_COUNTERS 4 // cycles, instructions, cache misses, branch misses
+
+struct phase_statistics {
+	uint64_t calls = 0;
+	uint64_t time_ns = 0;
+	uint64_t counters[NUM_COUNTERS] = {};
+};
+
+class Profiler
+{
+public:
+	bool m_enabled = false;
+	Profiler();
+	~Profiler();
+	void enable();
+	void reset();
+	void set_scope(std::string scope);
+	bool counters_available() const;
+	void read_counters(uint64_t *values) const;
+	void record(int phase, uint64_t time_ns, const uint64_t *counters);
+	void save(std::string path, std::string name) const;
+private:
+	int m_counter_fds[NUM_COUNTERS];
+	std::string m_scope;
+	std::vector<std::pair<std::string, std::vector<phase_statistics>>> m_scopes;
+};
+
+extern Profiler profiler;
+
+// measures the enclosing scope (or until stop) if profiling is enabled, hardware counters are only read for coarse phases since each read is a system call
+class ScopedPhase
+{
+public:
+	ScopedPhase(int phase, bool read_counters = true) : m_phase(phase), m_active(profiler.m_enabled), m_read_counters(read_counters) {
+		if (m_active) start();
+	}
+	~ScopedPhase() {
+		stop();
+	}
+	void stop() {
+		if (m_active) finish();
+		m_active = false;
+	}
+private:
+	int m_phase;
+	bool m_active;
+	bool m_read_counters;
+	Clock::time_point m_start;
+	uint64_t m_counters[NUM_COUNTERS];
+	void start();
+	void finish();
+};
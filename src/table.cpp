@@ -1,8 +1,13 @@
 #include "table.h"
+#include "profiler.h"
+#include "bounded_queue.h"
 
 #include <fstream>
 #include <sstream>
 #include <thread>
+#include <unordered_map>
+#include <algorithm>
+#include <memory>
 #include <boost/algorithm/string.hpp>
 
 Table::Table() {
@@ -10,6 +15,7 @@ Table::Table() {
 
 Table::Table(std::string path, char delimiter, int num_records) {
 	if (num_records < 1) return;
+	ScopedPhase phase(PHASE_CSV_LOAD);
 	std::ifstream infile(path);
 	std::string line;
 	getline(infile, line);
@@ -61,24 +67,39 @@ void Table::print_table() {
 int Table::num_uniques(record::size_type i_column) {
 	if (m_records.empty()) return 0;
 	if (i_column < 0 || i_column >= m_records[0].size()) throw "Requested number of unique values in non-existent column!";
-	std::set<std::string> fields;
-	for (record r : m_records) fields.insert(r[i_column]);
-	return (int)fields.size();
+	return statistics()[i_column].num_uniques;
+}
+
+const std::vector<column_statistics> &Table::statistics() {
+	if (m_statistics.size() != num_columns()) {
+		ScopedPhase phase(PHASE_COLUMN_PREPROCESSING);
+		m_statistics = profile_columns(m_records, m_approximate_statistics);
+	}
+	return m_statistics;
+}
+
+void Table::set_approximate_statistics(bool approximate) {
+	if (approximate != m_approximate_statistics) m_statistics.clear();
+	m_approximate_statistics = approximate;
 }
 
 void Table::delete_static_columns() {
 	if (m_records.empty()) return;
 	std::vector<record::size_type> remaining_indices;
 	for (record::size_type i_column = 0; i_column < m_records[0].size(); ++i_column) if (num_uniques(i_column) > 1) remaining_indices.push_back(i_column);
-	records new_records;
-	for (record r : m_records) {
+	reorder_columns(remaining_indices);
+}
+
+void Table::reorder_columns(const std::vector<record::size_type> &indices) {
+	for (record &r : m_records) {
 		record new_record;
-		for (auto i_column : remaining_indices) {
-			new_record.push_back(r[i_column]);
-		}
-		new_records.push_back(new_record);
+		new_record.reserve(indices.size());
+		for (auto i_column : indices) new_record.push_back(std::move(r[i_column]));
+		r.swap(new_record);
 	}
-	m_records = new_records;
+	std::vector<column_statistics> new_statistics;
+	if (!m_statistics.empty()) for (auto i_column : indices) new_statistics.push_back(m_statistics[i_column]);
+	m_statistics.swap(new_statistics);
 }
 
 bool Table::empty() const {
@@ -87,64 +108,207 @@ bool Table::empty() const {
 
 edge_vec Table::edges() const {
 	if (empty()) return edge_vec();
+	bool has_duplicates;
+	compact_rows rows = encode(has_duplicates);
+	if (has_duplicates) return edge_vec(1, edge(rows.num_columns)); // identical records share every column, nothing can hit the empty edge
+	std::vector<word_set> distinct(NUM_THREADS, word_set(rows.num_words));
+	ScopedPhase generation_phase(PHASE_DIFFERENCE_SET_GENERATION);
+	compare_rows(rows, 0, distinct);
+	generation_phase.stop();
+	return minimal_edges(rows, distinct);
+}
+
+compact_rows Table::encode(bool &has_duplicates) const {
+	compact_rows rows;
+	has_duplicates = false;
+	if (empty()) return rows;
+	ScopedPhase phase(PHASE_COLUMN_PREPROCESSING);
+	row_encoder encoder(m_records[0].size(), rows);
+	for (const record &r : m_records) if (!encoder.add(r)) has_duplicates = true;
+	return rows;
+}
+
+void Table::generate_edges(const compact_rows &rows, size_t first_new_row, std::atomic<size_t> &next_tile, size_t tile_size, word_set &distinct) {
+	std::vector<uint64_t> block(tile_size * rows.num_words);
+	for (size_t i_tile = next_tile++; i_tile * tile_size < rows.num_rows; i_tile = next_tile++) {
+		size_t i_begin = i_tile * tile_size;
+		size_t i_end = std::min(rows.num_rows, i_begin + tile_size);
+		for (size_t j_begin = std::max(i_begin, first_new_row); j_begin < rows.num_rows; j_begin += tile_size) {
+			size_t j_end = std::min(rows.num_rows, j_begin + tile_size);
+			for (size_t i_row = i_begin; i_row < i_end; ++i_row) {
+				size_t j_first = std::max(j_begin, i_row + 1);
+				if (j_first >= j_end) continue;
+				difference_block(rows, i_row, j_first, j_end, block.data());
+				for (size_t i_pair = 0; i_pair < j_end - j_first; ++i_pair) {
+					distinct.insert(block.data() + i_pair * rows.num_words);
+				}
+				// keeps memory proportional to the minimal sets instead of all distinct ones
+				if (distinct.size() - distinct.m_num_minimal >= std::max((size_t)MINIMIZE_THRESHOLD, distinct.m_num_minimal)) distinct.minimize();
+			}
+		}
+	}
+}
+
+void Table::compare_rows(const compact_rows &rows, size_t first_new_row, std::vector<word_set> &distinct) {
+	size_t tile_size = std::max((size_t)16, (size_t)32768 / (rows.stride * sizeof(uint32_t)));
+	std::atomic<size_t> next_tile(0);
 	std::thread threads[NUM_THREADS];
-	std::vector<edge_set> edge_sets(NUM_THREADS);
 	for (int i = 0; i < NUM_THREADS; ++i) {
-		edge_set edges = edge_sets[i];
-		threads[i] = std::thread(&Table::generate_edges, std::ref(m_records), (records::size_type)i, std::ref(edge_sets[i]));
+		threads[i] = std::thread(&Table::generate_edges, std::ref(rows), first_new_row, std::ref(next_tile), tile_size, std::ref(distinct[i]));
 	}
 	for (int i = 0; i < NUM_THREADS; ++i) threads[i].join();
-	edge_set edges = edge_sets[0];
-	for (int i = 1; i < NUM_THREADS; ++i) for (edge e : edge_sets[i]) edges.insert(e);
+}
+
+static void minimize_words(word_set &distinct) {
+	distinct.minimize();
+}
+
+edge_vec Table::minimal_edges(const compact_rows &rows, std::vector<word_set> &distinct) {
+	ScopedPhase phase(PHASE_MINIMIZATION);
+	std::thread threads[NUM_THREADS];
+	for (int i = 0; i < NUM_THREADS; ++i) threads[i] = std::thread(&minimize_words, std::ref(distinct[i]));
+	for (int i = 0; i < NUM_THREADS; ++i) threads[i].join();
+	// the threads mostly find the same minimal sets, so merging them one after another only compares the few new ones with all
+	word_set &merged = distinct[0];
+	for (int i = 1; i < NUM_THREADS; ++i) {
+		for (size_t i_word = 0; i_word < distinct[i].m_words.size(); i_word += rows.num_words) merged.insert(&distinct[i].m_words[i_word]);
+		distinct[i] = word_set(rows.num_words);
+		merged.minimize();
+	}
+	edge_set edges;
+	for (size_t i_word = 0; i_word < merged.m_words.size(); i_word += rows.num_words) edges.insert(edge_from_words(&merged.m_words[i_word], rows.num_words, rows.num_columns));
 	return edge_vec(edges.begin(), edges.end());
 }
 
-void Table::generate_edges(const records &m_records, records::size_type i_slice, edge_set &edges) {
-	for (records::size_type i_record = i_slice * m_records.size() / NUM_THREADS; i_record < (i_slice + 1) * m_records.size() / NUM_THREADS; ++i_record) {
-		for (records::size_type record_distance = 1; record_distance < m_records.size() - i_record; ++record_distance) {
-			edge new_edge(m_records[i_record].size());
-			for (edge::size_type i_column = 0; i_column < new_edge.size(); ++i_column) {
-				if (m_records[i_record][i_column] != m_records[i_record + record_distance][i_column]) new_edge[i_column] = 1;
-			}
-			bool insert = true;
-			edge_vec to_delete;
-			for (edge e : edges) {
-				if ((e & new_edge) == e) { // subset edge already exists
-					insert = false;
+// parses the file like the constructor does and hands the records over in batches
+static void read_batches(std::string path, char delimiter, bounded_queue<records> &batches) {
+	std::ifstream infile(path);
+	std::string line;
+	getline(infile, line);
+	record header;
+	boost::split(header, line, [delimiter](char c) {return c == delimiter; });
+	records batch(1, header);
+	int i_current_line = 2;
+	while (getline(infile, line)) {
+		record r;
+		boost::split(r, line, [delimiter](char c) {return c == delimiter; });
+		if (r.size() != header.size()) {
+			std::cerr << "Record in line " << i_current_line << " appears to be broken, should be " << header.size() << " but is " << r.size() << "!" << std::endl;
+			break;
+		}
+		batch.push_back(r);
+		i_current_line++;
+		if (batch.size() == PIPELINE_BATCH_SIZE) {
+			if (!batches.push(std::move(batch))) return;
+			batch = records();
+		}
+	}
+	if (!batch.empty()) batches.push(std::move(batch));
+	batches.close();
+}
+
+edge_vec Table::edges_from_file(std::string path, char delimiter, record::size_type &num_columns) {
+	bounded_queue<records> batches(PIPELINE_QUEUE_CAPACITY);
+	std::thread reader(&read_batches, path, delimiter, std::ref(batches));
+	compact_rows rows;
+	std::unique_ptr<row_encoder> encoder;
+	std::vector<word_set> distinct;
+	bool has_duplicates = false;
+	ScopedPhase generation_phase(PHASE_DIFFERENCE_SET_GENERATION);
+	// the rows of each batch are compared with all rows so far while the reader parses the next batches
+	for (records batch; !has_duplicates && batches.pop(batch); ) {
+		if (!encoder) {
+			encoder.reset(new row_encoder(batch[0].size(), rows));
+			distinct.assign(NUM_THREADS, word_set(rows.num_words));
+		}
+		size_t first_new_row = rows.num_rows;
+		for (const record &r : batch) if (!encoder->add(r)) has_duplicates = true;
+		if (!has_duplicates) compare_rows(rows, first_new_row, distinct);
+	}
+	batches.close();
+	reader.join();
+	generation_phase.stop();
+	num_columns = rows.num_columns;
+	if (has_duplicates) return edge_vec(1, edge(rows.num_columns));
+	return minimal_edges(rows, distinct);
+}
+
+static void sample_columns(const compact_rows &rows, size_t i_slice, word_set &distinct) {
+	// records agreeing on a column are neighbours once sorted by it, their difference sets tend to be small
+	std::vector<uint64_t> difference(rows.num_words);
+	std::vector<size_t> order(rows.num_rows);
+	for (size_t i_column = i_slice; i_column < rows.num_columns; i_column += NUM_THREADS) {
+		for (size_t i = 0; i < order.size(); ++i) order[i] = i;
+		std::stable_sort(order.begin(), order.end(), [&rows, i_column](size_t a, size_t b) { return rows.row(a)[i_column] < rows.row(b)[i_column]; });
+		for (size_t i = 0; i + 1 < order.size(); ++i) {
+			if (rows.row(order[i])[i_column] != rows.row(order[i + 1])[i_column]) continue;
+			difference_block(rows, order[i], order[i + 1], order[i + 1] + 1, difference.data());
+			distinct.insert(difference.data());
+		}
+	}
+}
+
+edge_vec Table::sampled_edges(const compact_rows &rows) {
+	std::vector<word_set> distinct(NUM_THREADS, word_set(rows.num_words));
+	if (rows.num_rows >= 2) {
+		std::vector<uint64_t> difference(rows.num_words);
+		difference_block(rows, 0, 1, 2, difference.data());
+		distinct[0].insert(difference.data());
+	}
+	std::thread threads[NUM_THREADS];
+	for (int i = 0; i < NUM_THREADS; ++i) threads[i] = std::thread(&sample_columns, std::ref(rows), (size_t)i, std::ref(distinct[i]));
+	for (int i = 0; i < NUM_THREADS; ++i) threads[i].join();
+	return minimal_edges(rows, distinct);
+}
+
+static void find_violations_slice(const compact_rows &rows, const edge_vec &sets, size_t i_slice, edge_vec &differences) {
+	std::unordered_map<size_t, std::vector<size_t>> projections;
+	std::vector<size_t> columns;
+	std::vector<uint64_t> difference(rows.num_words);
+	for (size_t i_set = i_slice; i_set < sets.size(); i_set += NUM_THREADS) {
+		columns.clear();
+		for (auto i_column = sets[i_set].find_first(); i_column != edge::npos; i_column = sets[i_set].find_next(i_column)) columns.push_back(i_column);
+		projections.clear();
+		bool unique = true;
+		for (size_t j_row = 0; unique && j_row < rows.num_rows; ++j_row) {
+			const uint32_t *row = rows.row(j_row);
+			size_t hash = columns.size();
+			for (size_t i_column : columns) hash ^= row[i_column] + 0x9e3779b97f4a7c15ULL + (hash << 6) + (hash >> 2);
+			std::vector<size_t> &candidates = projections[hash];
+			for (size_t i_row : candidates) {
+				const uint32_t *other = rows.row(i_row);
+				if (std::all_of(columns.begin(), columns.end(), [row, other](size_t i_column) { return row[i_column] == other[i_column]; })) {
+					difference_block(rows, i_row, j_row, j_row + 1, difference.data());
+					differences[i_set] = edge_from_words(difference.data(), rows.num_words, rows.num_columns);
+					unique = false;
 					break;
 				}
-				if ((e & new_edge) == new_edge) { // new edge is subset of other one
-					to_delete.push_back(e);
-				}
-			}
-			if (insert) {
-				for (auto e : to_delete) edges.erase(e);
-				edges.insert(new_edge);
 			}
+			candidates.push_back(j_row);
 		}
 	}
 }
 
+void Table::find_violations(const compact_rows &rows, const edge_vec &sets, edge_vec &differences) {
+	// differences[i] is the difference set of two records that agree on sets[i], empty if sets[i] is unique
+	differences.assign(sets.size(), edge());
+	std::thread threads[NUM_THREADS];
+	for (int i = 0; i < NUM_THREADS; ++i) threads[i] = std::thread(&find_violations_slice, std::ref(rows), std::ref(sets), (size_t)i, std::ref(differences));
+	for (int i = 0; i < NUM_THREADS; ++i) threads[i].join();
+}
+
 void Table::sort_columns_descending_uniqueness() {
 	auto mmap = uniques_mmap();
-	records new_records;
-	for (record r : m_records) {
-		record new_record;
-		for (auto i = mmap.rbegin(); i != mmap.rend(); ++i) new_record.push_back(r[i->second]);
-		new_records.push_back(new_record);
-	}
-	m_records = new_records;
+	std::vector<record::size_type> indices;
+	for (auto i = mmap.rbegin(); i != mmap.rend(); ++i) indices.push_back(i->second);
+	reorder_columns(indices);
 }
 
 void Table::sort_columns_ascending_uniqueness() {
 	auto mmap = uniques_mmap();
-	records new_records;
-	for (record r : m_records) {
-		record new_record;
-		for (auto i = mmap.begin(); i != mmap.end(); ++i) new_record.push_back(r[i->second]);
-		new_records.push_back(new_record);
-	}
-	m_records = new_records;
+	std::vector<record::size_type> indices;
+	for (auto i = mmap.begin(); i != mmap.end(); ++i) indices.push_back(i->second);
+	reorder_columns(indices);
 }
 
 void Table::sort_records() {
@@ -174,8 +338,10 @@ void Table::save(std::string path, std::vector<std::string> header) {
 
 void Table::add_record(record r) {
 	m_records.push_back(r);
+	m_statistics.clear();
 }
 
 void Table::clear() {
 	m_records.clear();
+	m_statistics.clear();
 }
\ No newline at end of file
@@ -1,11 +1,15 @@
 #pragma once
 
 #include "globals.h"
+#include "difference_sets.h"
+#include "column_statistics.h"
 
 #include <map>
+#include <atomic>
 
-typedef std::vector<std::string> record;
-typedef std::vector<record> records;
+#define PIPELINE_BATCH_SIZE 4096 // records parsed ahead of the difference set generation at once
+#define PIPELINE_QUEUE_CAPACITY 4
+#define MINIMIZE_THRESHOLD 16384 // new difference sets a thread collects at least before it drops the non-minimal ones
 
 class Table
 {
@@ -19,10 +23,18 @@ public:
 	~Table();
 	void print_table();
 	int num_uniques(record::size_type i_column);
+	const std::vector<column_statistics> &statistics();
+	void set_approximate_statistics(bool approximate);
 	void delete_static_columns();
 	bool empty() const;
 	edge_vec edges() const;
-	static void generate_edges(const records &m_records, records::size_type i_slice, edge_set &edges);
+	compact_rows encode(bool &has_duplicates) const;
+	static void generate_edges(const compact_rows &rows, size_t first_new_row, std::atomic<size_t> &next_tile, size_t tile_size, word_set &distinct);
+	static void compare_rows(const compact_rows &rows, size_t first_new_row, std::vector<word_set> &distinct);
+	static edge_vec minimal_edges(const compact_rows &rows, std::vector<word_set> &distinct);
+	static edge_vec edges_from_file(std::string path, char delimiter, record::size_type &num_columns);
+	static edge_vec sampled_edges(const compact_rows &rows);
+	static void find_violations(const compact_rows &rows, const edge_vec &sets, edge_vec &differences);
 	void sort_columns_descending_uniqueness();
 	void sort_columns_ascending_uniqueness();
 	void sort_records();
@@ -30,4 +42,8 @@ public:
 	void save(std::string path, std::vector<std::string> header = std::vector<std::string>());
 	void add_record(record r);
 	void clear();
+private:
+	std::vector<column_statistics> m_statistics; // cached, cleared by the members that change records
+	bool m_approximate_statistics = false;
+	void reorder_columns(const std::vector<record::size_type> &indices);
 };
\ No newline at end of file